@@ -0,0 +1,53 @@
+// Replacement global allocation functions that count allocations per thread
+
+#include "harness.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+    thread_local std::uint64_t allocations = 0;
+    thread_local std::uint64_t bytes = 0;
+
+    void* allocate(std::size_t size) {
+        ++allocations;
+        bytes += size;
+        if(void *p = std::malloc(size ? size : 1))
+            return p;
+        throw std::bad_alloc();
+    }
+
+}
+
+std::uint64_t hlh_bench::allocationCount() {
+    return allocations;
+}
+
+std::uint64_t hlh_bench::allocatedBytes() {
+    return bytes;
+}
+
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+    std::free(p);
+}
@@ -0,0 +1,87 @@
+// A corpus of realistic Link header field values for benchmarking
+
+#ifndef HLH_BENCHMARK_CORPUS_H
+#define HLH_BENCHMARK_CORPUS_H
+
+#include <string>
+#include <vector>
+
+namespace hlh_bench {
+
+    class CorpusEntry {
+    public:
+        /** short name used in benchmark names */
+        std::string name;
+
+        /** the value of the Link header field */
+        std::string header;
+
+        /** the URI the header is resolved against, possibly empty */
+        std::string baseUri;
+    };
+
+    /**
+     * @return the benchmark corpus, built without any network access
+     */
+    inline std::vector<CorpusEntry> corpus() {
+        std::vector<CorpusEntry> entries;
+
+        entries.push_back({"single",
+                           R"(<https://example.com/TheBook/chapter2>; rel="previous"; title="previous chapter")",
+                           ""});
+
+        entries.push_back({"github-pagination",
+                           R"(<https://api.github.com/repositories/1300192/issues?page=2>; rel="prev", )"
+                           R"(<https://api.github.com/repositories/1300192/issues?page=4>; rel="next", )"
+                           R"(<https://api.github.com/repositories/1300192/issues?page=515>; rel="last", )"
+                           R"(<https://api.github.com/repositories/1300192/issues?page=1>; rel="first")",
+                           ""});
+
+        std::string preloads;
+        for(int i = 0; i < 200; ++i) {
+            if(i)
+                preloads += ", ";
+            switch(i % 4) {
+                case 0:
+                    preloads += "</static/js/chunk-" + std::to_string(i) + ".js>; rel=preload; as=script; nopush";
+                    break;
+                case 1:
+                    preloads += "</static/css/style-" + std::to_string(i) + ".css>; rel=\"preload stylesheet\"; as=style";
+                    break;
+                case 2:
+                    preloads += "<https://fonts.example.net/f" + std::to_string(i) +
+                                ".woff2>; rel=preload; as=font; type=\"font/woff2\"; crossorigin";
+                    break;
+                default:
+                    preloads += "<https://cdn.example.net>; rel=preconnect";
+                    break;
+            }
+        }
+        entries.push_back({"preload-list", preloads, "https://www.example.com/index.html"});
+
+        entries.push_back({"anchors",
+                           R"(</terms>; rel="copyright"; anchor="#foo", )"
+                           R"(<http://example.org/>; rel="start http://example.net/relation/other"; anchor="/", )"
+                           R"(</TheBook/chapter2>; rel="previous"; anchor="#chapter3"; title="previous chapter", )"
+                           R"(</TheBook/chapter4>; rel="next"; anchor="../book#chapter3"; title="next chapter", )"
+                           R"(<../privacy>; rel="policy"; anchor="https://corporate.example.org")",
+                           "https://example.org/a/b"});
+
+        entries.push_back({"escaped-titles",
+                           R"(</one>; rel=item; title="a \"quoted\" title with a \\ backslash", )"
+                           R"(</two>; rel=item; title="another \"escaped\" \\\"title\\\"", )"
+                           R"(</three>; rel=item; title*=UTF-8'de'n%c3%a4chstes%20Kapitel; title="fallback")",
+                           ""});
+
+        entries.push_back({"relative-targets",
+                           R"(<terms>; rel="copyright", <../privacy>; rel="policy", )"
+                           R"(<./a/b/../c?x=1>; rel="related", <//cdn.example.net/x.js>; rel="preload"; as=script, )"
+                           R"(<?page=3>; rel="next", <#top>; rel="start")",
+                           "https://example.org/a/b/c?q"});
+
+        return entries;
+    }
+
+}
+
+#endif //HLH_BENCHMARK_CORPUS_H
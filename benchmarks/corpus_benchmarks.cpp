@@ -0,0 +1,112 @@
+// Benchmarks of parse() and its building blocks over the benchmark corpus
+
+#include "http-link-header.h"
+#include "corpus.h"
+#include "harness.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * The pieces of a header that the individual building blocks of parse()
+     * work on.
+     */
+    class Pieces {
+    public:
+        std::vector<std::string> targets;
+        std::vector<std::string> parameters;
+        std::vector<std::string> quotedStrings;
+    };
+
+    Pieces split(const std::string &header) {
+        Pieces pieces;
+        const char *p = header.data();
+        const char *end = p + header.size();
+        while(p != end) {
+            http_link_header::StringView target;
+            bool found = http_link_header::detail::scanLinkValue(p, end, target, [&](
+                    const http_link_header::detail::RawParameter &param) {
+                if(param.quoted)
+                    pieces.quotedStrings.push_back('"' + param.value.str() + '"');
+            });
+            if(!found)
+                break;
+            pieces.targets.push_back(target.str());
+            pieces.parameters.push_back(std::string(target.end() + 1, p));
+        }
+        return pieces;
+    }
+
+    std::size_t totalSize(const std::vector<std::string> &strings) {
+        std::size_t size = 0;
+        for(const auto &s : strings)
+            size += s.size();
+        return size;
+    }
+
+}
+
+void runCorpusBenchmarks(hlh_bench::Suite &suite) {
+    for(const auto &entry : hlh_bench::corpus()) {
+        const std::string &header = entry.header;
+        const std::string &baseUri = entry.baseUri;
+        Pieces pieces = split(header);
+        std::size_t links = http_link_header::parse(header, baseUri).size();
+
+        suite.run("parse/" + entry.name, {header.size(), links}, [&] {
+            hlh_bench::doNotOptimize(http_link_header::parse(header, baseUri));
+        });
+
+        suite.run("parseGroups/" + entry.name, {header.size(), links}, [&] {
+            hlh_bench::doNotOptimize(http_link_header::parseGroups(header, baseUri));
+        });
+
+        // the header in the header section of a typical response
+        std::string block = "HTTP/1.1 200 OK\r\n"
+                            "Date: Mon, 19 Oct 2026 08:00:00 GMT\r\n"
+                            "Content-Type: text/html; charset=utf-8\r\n"
+                            "Content-Length: 4096\r\n"
+                            "Cache-Control: max-age=600\r\n"
+                            "ETag: \"5f3c2a1b\"\r\n"
+                            "Link: " + header + "\r\n"
+                            "Vary: Accept-Encoding\r\n"
+                            "Server: example\r\n"
+                            "\r\n";
+        suite.run("parse_from_header_block/" + entry.name, {block.size(), links}, [&] {
+            hlh_bench::doNotOptimize(http_link_header::parse_from_header_block(block.data(), block.size(), baseUri));
+        });
+
+        // the inputs are copied into a buffer with enough capacity, so the
+        // copy neither allocates nor dominates the measurement
+        std::string input;
+        input.reserve(header.size());
+
+        suite.run("parseParameters/" + entry.name, {totalSize(pieces.parameters), pieces.parameters.size()}, [&] {
+            for(const auto &parameters : pieces.parameters) {
+                input.assign(parameters);
+                hlh_bench::doNotOptimize(http_link_header::parseParameters(input));
+            }
+        });
+
+        if(!pieces.quotedStrings.empty()) {
+            suite.run("parseQuotedString/" + entry.name, {totalSize(pieces.quotedStrings), 0}, [&] {
+                for(const auto &quoted : pieces.quotedStrings) {
+                    input.assign(quoted);
+                    hlh_bench::doNotOptimize(http_link_header::parseQuotedString(input));
+                }
+            });
+        }
+
+        if(!baseUri.empty()) {
+            std::string result;
+            suite.run("uri::resolve/" + entry.name, {totalSize(pieces.targets), pieces.targets.size()}, [&] {
+                for(const auto &target : pieces.targets) {
+                    http_link_header::uri::resolve(&baseUri, &target, &result);
+                    hlh_bench::doNotOptimize(result);
+                }
+            });
+        }
+    }
+}
@@ -0,0 +1,139 @@
+// Hardware performance counters for the benchmark harness
+//
+// On Linux the counters are read through perf_event_open(2). Elsewhere, or
+// when the kernel does not allow it (see /proc/sys/kernel/perf_event_paranoid),
+// no counter is available and the harness reports wall-clock time only.
+
+#ifndef HLH_BENCHMARK_COUNTERS_H
+#define HLH_BENCHMARK_COUNTERS_H
+
+#include <cstdint>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace hlh_bench {
+
+    class Counters {
+    public:
+        enum Event {
+            Cycles,
+            Instructions,
+            BranchMisses,
+            L1dMisses,
+            LlcMisses,
+            EventCount
+        };
+
+        static const char* name(Event event) {
+            static const char *const names[EventCount] = {
+                    "cycles", "instructions", "branch-misses", "L1d-misses", "LLC-misses"};
+            return names[event];
+        }
+
+        Counters() {
+            for(int &fd : fds_)
+                fd = -1;
+            for(std::uint64_t &value : values_)
+                value = 0;
+#if defined(__linux__)
+            const std::uint64_t l1dReadMiss = PERF_COUNT_HW_CACHE_L1D |
+                                              (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            open(Cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+            open(Instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+            open(BranchMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+            open(L1dMisses, PERF_TYPE_HW_CACHE, l1dReadMiss);
+            open(LlcMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+#endif
+        }
+
+        ~Counters() {
+#if defined(__linux__)
+            for(int fd : fds_) {
+                if(fd >= 0)
+                    close(fd);
+            }
+#endif
+        }
+
+        Counters(const Counters &) = delete;
+        Counters& operator=(const Counters &) = delete;
+
+        bool available(Event event) const {
+            return fds_[event] >= 0;
+        }
+
+        bool anyAvailable() const {
+            for(int fd : fds_) {
+                if(fd >= 0)
+                    return true;
+            }
+            return false;
+        }
+
+        void start() {
+#if defined(__linux__)
+            for(int fd : fds_) {
+                if(fd >= 0) {
+                    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                }
+            }
+#endif
+        }
+
+        void stop() {
+#if defined(__linux__)
+            for(int i = 0; i < EventCount; ++i) {
+                if(fds_[i] < 0)
+                    continue;
+                ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+
+                // value, time enabled, time running; scaled in case the
+                // kernel had to multiplex the counters
+                std::uint64_t data[3] = {0, 0, 0};
+                if(read(fds_[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0)
+                    values_[i] = 0;
+                else
+                    values_[i] = static_cast<std::uint64_t>(
+                            static_cast<double>(data[0]) * static_cast<double>(data[1]) / static_cast<double>(data[2]));
+            }
+#endif
+        }
+
+        /**
+         * @return the count of event between the last start() and stop()
+         */
+        std::uint64_t value(Event event) const {
+            return values_[event];
+        }
+
+    private:
+#if defined(__linux__)
+        void open(Event event, std::uint32_t type, std::uint64_t config) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds_[event] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+
+        int fds_[EventCount];
+        std::uint64_t values_[EventCount];
+    };
+
+}
+
+#endif //HLH_BENCHMARK_COUNTERS_H
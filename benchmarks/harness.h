@@ -0,0 +1,208 @@
+// A small self-contained benchmark harness for http-link-header-cpp
+
+#ifndef HLH_BENCHMARK_HARNESS_H
+#define HLH_BENCHMARK_HARNESS_H
+
+#include "counters.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace hlh_bench {
+
+    /**
+     * Keeps the compiler from optimizing away a benchmarked result.
+     */
+    template<typename T>
+    inline void doNotOptimize(const T &value) {
+#if defined(__GNUC__)
+        asm volatile("" : : "r"(&value) : "memory");
+#else
+        static const void *volatile sink;
+        sink = &value;
+#endif
+    }
+
+    /**
+     * Number of calls to operator new, and bytes requested, on this thread so
+     * far. Counted by the replacement operators in allocations.cpp.
+     */
+    std::uint64_t allocationCount();
+    std::uint64_t allocatedBytes();
+
+    /**
+     * The amount of work done by one call of a benchmark, used to derive
+     * per-link and per-byte figures.
+     */
+    class Work {
+    public:
+        std::size_t bytes;
+        std::size_t links;
+    };
+
+    class Result {
+    public:
+        std::string name;
+        std::size_t iterations;
+        double nsPerCall;
+        double allocationsPerCall;
+        double allocatedBytesPerCall;
+        Work work;
+
+        /** hardware counter values per call, negative if not available */
+        double countersPerCall[Counters::EventCount];
+
+        /**
+         * @return the value of a hardware counter per unit of work, or a
+         *         negative number if it is not available
+         */
+        double counterPer(Counters::Event event, std::size_t units) const {
+            double perCall = countersPerCall[event];
+            return perCall < 0 || units == 0 ? -1 : perCall / static_cast<double>(units);
+        }
+
+        double nsPerLink() const {
+            return work.links ? nsPerCall / static_cast<double>(work.links) : 0;
+        }
+
+        double bytesPerSecond() const {
+            return nsPerCall > 0 ? static_cast<double>(work.bytes) * 1e9 / nsPerCall : 0;
+        }
+    };
+
+    /**
+     * Runs benchmarks whose name contains a filter string and collects their
+     * results.
+     */
+    class Suite {
+    public:
+        explicit Suite(std::string filter = "", double minSeconds = 0.2, int repetitions = 1)
+                : filter_(std::move(filter)), minSeconds_(minSeconds), repetitions_(repetitions) {}
+
+        /**
+         * Calls fn repeatedly, doubling the number of calls until a run takes
+         * at least minSeconds, and records the time per call of that run and
+         * the allocations per call. With more than one repetition the run is
+         * repeated and the fastest one is kept, which filters out noise from
+         * other processes.
+         */
+        template<typename Fn>
+        void run(const std::string &name, Work work, Fn &&fn) {
+            typedef std::chrono::steady_clock Clock;
+
+            if(name.find(filter_) == std::string::npos)
+                return;
+
+            // warm up caches and the allocator
+            fn();
+
+            std::uint64_t allocations = allocationCount();
+            std::uint64_t bytes = allocatedBytes();
+            fn();
+            Result result{name, 0, 0,
+                          static_cast<double>(allocationCount() - allocations),
+                          static_cast<double>(allocatedBytes() - bytes),
+                          work, {}};
+
+            std::size_t iterations = 1;
+            for(;;) {
+                auto start = Clock::now();
+                for(std::size_t i = 0; i < iterations; ++i)
+                    fn();
+                std::chrono::duration<double> elapsed = Clock::now() - start;
+
+                if(elapsed.count() >= minSeconds_ || iterations >= (std::size_t(1) << 40)) {
+                    result.iterations = iterations;
+                    result.nsPerCall = elapsed.count() * 1e9 / static_cast<double>(iterations);
+                    break;
+                }
+                iterations *= 2;
+            }
+
+            for(int repetition = 1; repetition < repetitions_; ++repetition) {
+                auto start = Clock::now();
+                for(std::size_t i = 0; i < iterations; ++i)
+                    fn();
+                std::chrono::duration<double> elapsed = Clock::now() - start;
+                double nsPerCall = elapsed.count() * 1e9 / static_cast<double>(iterations);
+                if(nsPerCall < result.nsPerCall)
+                    result.nsPerCall = nsPerCall;
+            }
+
+            // a separate run for the hardware counters, so reading them
+            // does not disturb the timing
+            for(int event = 0; event < Counters::EventCount; ++event)
+                result.countersPerCall[event] = -1;
+            if(counters_.anyAvailable()) {
+                counters_.start();
+                for(std::size_t i = 0; i < iterations; ++i)
+                    fn();
+                counters_.stop();
+                for(int event = 0; event < Counters::EventCount; ++event) {
+                    auto e = static_cast<Counters::Event>(event);
+                    if(counters_.available(e))
+                        result.countersPerCall[event] =
+                                static_cast<double>(counters_.value(e)) / static_cast<double>(iterations);
+                }
+            }
+
+            print(result);
+            results_.push_back(result);
+        }
+
+        const std::vector<Result>& results() const {
+            return results_;
+        }
+
+        void printHeader() const {
+            std::printf("%-56s %12s %10s %10s %10s %10s\n",
+                        "benchmark", "ns/call", "ns/link", "MB/s", "allocs", "bytes");
+            if(counters_.anyAvailable())
+                std::printf("%-56s %12s %10s %10s %10s %10s\n",
+                            "", "cycles/B", "instr/B", "br-miss/l", "L1d-miss/l", "LLC-miss/l");
+            else
+                std::printf("(hardware counters unavailable, reporting wall-clock time only)\n");
+        }
+
+        static void print(const Result &result) {
+            std::printf("%-56s %12.1f %10.1f %10.1f %10.1f %10.0f\n",
+                        result.name.c_str(), result.nsPerCall, result.nsPerLink(),
+                        result.bytesPerSecond() / 1e6, result.allocationsPerCall,
+                        result.allocatedBytesPerCall);
+
+            bool any = false;
+            for(double value : result.countersPerCall)
+                any = any || value >= 0;
+            if(!any)
+                return;
+            std::printf("%-56s %12s %10s %10s %10s %10s\n", "",
+                        perUnit(result.countersPerCall[Counters::Cycles], result.work.bytes).c_str(),
+                        perUnit(result.countersPerCall[Counters::Instructions], result.work.bytes).c_str(),
+                        perUnit(result.countersPerCall[Counters::BranchMisses], result.work.links).c_str(),
+                        perUnit(result.countersPerCall[Counters::L1dMisses], result.work.links).c_str(),
+                        perUnit(result.countersPerCall[Counters::LlcMisses], result.work.links).c_str());
+        }
+
+    private:
+        static std::string perUnit(double perCall, std::size_t units) {
+            if(perCall < 0 || units == 0)
+                return "-";
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.2f", perCall / static_cast<double>(units));
+            return buffer;
+        }
+
+        Counters counters_;
+        std::string filter_;
+        double minSeconds_;
+        int repetitions_;
+        std::vector<Result> results_;
+    };
+
+}
+
+#endif //HLH_BENCHMARK_HARNESS_H
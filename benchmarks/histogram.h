@@ -0,0 +1,109 @@
+// A latency histogram with logarithmic buckets, in the style of HdrHistogram
+
+#ifndef HLH_BENCHMARK_HISTOGRAM_H
+#define HLH_BENCHMARK_HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hlh_bench {
+
+    /**
+     * Counts values, such as latencies in nanoseconds, in buckets whose
+     * width grows with the value so that every recorded value is kept to
+     * within 1/64 (about 1.6%) of its magnitude, from 0 up to 2^64 - 1.
+     *
+     * Values below 128 get a bucket each. Above that every power of two is
+     * split into 64 equal sub-buckets.
+     */
+    class Histogram {
+    public:
+        Histogram() : counts_(bucketCount, 0), total_(0), max_(0) {}
+
+        void record(std::uint64_t value) {
+            ++counts_[index(value)];
+            ++total_;
+            if(value > max_)
+                max_ = value;
+        }
+
+        void add(const Histogram &other) {
+            for(std::size_t i = 0; i < bucketCount; ++i)
+                counts_[i] += other.counts_[i];
+            total_ += other.total_;
+            if(other.max_ > max_)
+                max_ = other.max_;
+        }
+
+        std::uint64_t count() const {
+            return total_;
+        }
+
+        std::uint64_t max() const {
+            return max_;
+        }
+
+        /**
+         * @param quantile between 0 and 1, e.g. 0.999 for the 99.9th percentile
+         *
+         * @return the highest value that falls into the same bucket as the
+         *         value at quantile, or 0 if nothing was recorded
+         */
+        std::uint64_t percentile(double quantile) const {
+            if(total_ == 0)
+                return 0;
+            auto rank = static_cast<std::uint64_t>(quantile * static_cast<double>(total_) + 0.5);
+            if(rank == 0)
+                rank = 1;
+            std::uint64_t seen = 0;
+            for(std::size_t i = 0; i < bucketCount; ++i) {
+                seen += counts_[i];
+                if(seen >= rank) {
+                    std::uint64_t highest = highestValue(i);
+                    return highest < max_ ? highest : max_;
+                }
+            }
+            return max_;
+        }
+
+    private:
+        enum {
+            subBucketBits = 7,
+            subBucketCount = 1 << subBucketBits,
+            halfCount = subBucketCount / 2,
+            bucketCount = subBucketCount + (64 - subBucketBits) * halfCount
+        };
+
+        static unsigned highestBit(std::uint64_t value) {
+            unsigned bit = 0;
+            while(value >>= 1)
+                ++bit;
+            return bit;
+        }
+
+        static std::size_t index(std::uint64_t value) {
+            if(value < subBucketCount)
+                return static_cast<std::size_t>(value);
+            // value >> shift is in [halfCount, subBucketCount)
+            unsigned shift = highestBit(value) - (subBucketBits - 1);
+            return subBucketCount + (shift - 1) * halfCount +
+                   static_cast<std::size_t>((value >> shift) - halfCount);
+        }
+
+        static std::uint64_t highestValue(std::size_t index) {
+            if(index < subBucketCount)
+                return index;
+            std::size_t shift = (index - subBucketCount) / halfCount + 1;
+            std::uint64_t sub = (index - subBucketCount) % halfCount + halfCount;
+            return ((sub + 1) << shift) - 1;
+        }
+
+        std::vector<std::uint64_t> counts_;
+        std::uint64_t total_;
+        std::uint64_t max_;
+    };
+
+}
+
+#endif //HLH_BENCHMARK_HISTOGRAM_H
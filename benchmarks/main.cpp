@@ -0,0 +1,80 @@
+// Runs the http-link-header-cpp benchmarks
+//
+// usage: benchmarks [--filter <substring>] [--min-time <seconds>] [--repetitions <n>]
+//                   [--json <file>] [--baseline <file> [--tolerance <fraction>]]
+//
+// With --baseline the exit status is 1 if any benchmark listed in the
+// baseline got slower by more than the tolerance (default 0.3, i.e. 30%).
+// A baseline is written with --json; benchmarks missing from it are not
+// compared.
+//
+// The pathological/ benchmarks also check that time and memory grow no more
+// than linearly with the size of adversarial inputs; the exit status is 1 if
+// one of them does not.
+
+#include "harness.h"
+#include "report.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+void runCorpusBenchmarks(hlh_bench::Suite &suite);
+void runParametersBenchmarks(hlh_bench::Suite &suite);
+void runRelationsBenchmarks(hlh_bench::Suite &suite);
+int runPathologicalBenchmarks(hlh_bench::Suite &suite);
+
+int main(int argc, char *argv[]) {
+    std::string filter;
+    double minSeconds = 0.2;
+    int repetitions = 1;
+    std::string jsonPath;
+    std::string baselinePath;
+    double tolerance = 0.3;
+
+    for(int i = 1; i < argc; ++i) {
+        if(std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else if(std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+            minSeconds = std::atof(argv[++i]);
+        else if(std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc)
+            repetitions = std::atoi(argv[++i]);
+        else if(std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if(std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+            baselinePath = argv[++i];
+        else if(std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+            tolerance = std::atof(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: %s [--filter <substring>] [--min-time <seconds>] [--repetitions <n>]\n"
+                                 "       [--json <file>] [--baseline <file> [--tolerance <fraction>]]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if(!baselinePath.empty() && !hlh_bench::readBaseline(baselinePath, baseline)) {
+        std::fprintf(stderr, "cannot read baseline %s\n", baselinePath.c_str());
+        return 2;
+    }
+
+    hlh_bench::Suite suite(filter, minSeconds, repetitions);
+    suite.printHeader();
+
+    runCorpusBenchmarks(suite);
+    runParametersBenchmarks(suite);
+    runRelationsBenchmarks(suite);
+    int scalingFailures = runPathologicalBenchmarks(suite);
+
+    if(!jsonPath.empty() && !hlh_bench::writeResults(jsonPath, suite.results(), baseline)) {
+        std::fprintf(stderr, "cannot write %s\n", jsonPath.c_str());
+        return 2;
+    }
+
+    if(!baselinePath.empty() && hlh_bench::countRegressions(suite.results(), baseline, tolerance) != 0)
+        return 1;
+
+    return scalingFailures != 0 ? 1 : 0;
+}
@@ -0,0 +1,61 @@
+// Benchmarks for the link parameter processing of parse() (steps 9 to 16)
+
+#include "http-link-header.h"
+#include "harness.h"
+
+#include <string>
+
+namespace {
+
+    /**
+     * A link-value with count parameters, including repeated rel, anchor,
+     * title and type parameters and a few star parameters.
+     */
+    std::string manyParameters(std::size_t count) {
+        std::string header = "<https://example.com/resource>";
+        for(std::size_t i = 0; i < count; ++i) {
+            switch(i % 8) {
+                case 0: header += "; rel=\"preload\""; break;
+                case 1: header += "; anchor=\"#a" + std::to_string(i) + "\""; break;
+                case 2: header += "; title=\"title " + std::to_string(i) + "\""; break;
+                case 3: header += "; type=text/css"; break;
+                case 4: header += "; title*=UTF-8''t" + std::to_string(i); break;
+                case 5: header += "; x" + std::to_string(i) + "*=v"; break;
+                default: header += "; x" + std::to_string(i) + "=v"; break;
+            }
+        }
+        return header;
+    }
+
+    /**
+     * A link-value with count relation types and a few target attributes.
+     */
+    std::string manyRelations(std::size_t count) {
+        std::string header = "<https://example.com/resource>; title=\"a title\"; type=text/html; rel=\"";
+        for(std::size_t i = 0; i < count; ++i)
+            header += (i % 2 ? " preload" : " x-rel-") + std::to_string(i);
+        return header + "\"";
+    }
+
+}
+
+void runParametersBenchmarks(hlh_bench::Suite &suite) {
+    for(std::size_t count : {8, 64, 512, 4096}) {
+        std::string header = manyParameters(count);
+        suite.run("parse/parameters-" + std::to_string(count), {header.size(), 1}, [&] {
+            hlh_bench::doNotOptimize(http_link_header::parse(header));
+        });
+    }
+}
+
+void runRelationsBenchmarks(hlh_bench::Suite &suite) {
+    for(std::size_t count : {4, 64, 1024}) {
+        std::string header = manyRelations(count);
+        suite.run("parse/relations-" + std::to_string(count), {header.size(), count}, [&] {
+            hlh_bench::doNotOptimize(http_link_header::parse(header));
+        });
+        suite.run("parseGroups/relations-" + std::to_string(count), {header.size(), count}, [&] {
+            hlh_bench::doNotOptimize(http_link_header::parseGroups(header));
+        });
+    }
+}
@@ -0,0 +1,118 @@
+// Generators of adversarial Link header field values
+
+#ifndef HLH_BENCHMARK_PATHOLOGICAL_H
+#define HLH_BENCHMARK_PATHOLOGICAL_H
+
+#include <cstddef>
+#include <string>
+
+namespace hlh_bench {
+
+    /**
+     * count short link-values, about 25 bytes each: 50000 links make a
+     * header of about 1 MB.
+     */
+    inline std::string manyLinks(std::size_t count) {
+        std::string header;
+        for(std::size_t i = 0; i < count; ++i) {
+            if(i != 0)
+                header += ", ";
+            header += "</page/" + std::to_string(i) + ">; rel=next";
+        }
+        return header;
+    }
+
+    /**
+     * A link-value with count distinct parameters, including repeated
+     * title parameters.
+     */
+    inline std::string manyDistinctParameters(std::size_t count) {
+        std::string header = "<https://example.com/>; rel=\"preload\"";
+        for(std::size_t i = 0; i < count; ++i)
+            header += (i % 4 ? "; p" + std::to_string(i) + "=v" : std::string("; title=\"t\""));
+        return header;
+    }
+
+    /**
+     * A link-value whose rel parameter has count relation types, half of
+     * them extension relation types.
+     */
+    inline std::string manyRelationTokens(std::size_t count) {
+        std::string header = "<https://example.com/>; type=text/html; rel=\"";
+        for(std::size_t i = 0; i < count; ++i)
+            header += (i % 2 ? " preload" : " https://example.com/rel/") + std::to_string(i);
+        return header + "\"";
+    }
+
+    /**
+     * A link-value with count relation types and count parameters, for which
+     * parse() returns count * count target attributes in total.
+     */
+    inline std::string manyRelationsAndParameters(std::size_t count) {
+        std::string header = "<https://example.com/>; rel=\"";
+        for(std::size_t i = 0; i < count; ++i)
+            header += " r" + std::to_string(i);
+        header += "\"";
+        for(std::size_t i = 0; i < count; ++i)
+            header += "; p" + std::to_string(i) + "=v";
+        return header;
+    }
+
+    /**
+     * A quoted string made of count backslash escapes.
+     */
+    inline std::string backslashEscapes(std::size_t count) {
+        std::string quoted = "\"";
+        for(std::size_t i = 0; i < count; ++i)
+            quoted += i % 2 ? "\\\\" : "\\\"";
+        return quoted + "\"";
+    }
+
+    /**
+     * A target of count "../" segments, resolved against dotSegmentsBase().
+     */
+    inline std::string dotSegments(std::size_t count) {
+        std::string header = "<";
+        for(std::size_t i = 0; i < count; ++i)
+            header += "../";
+        return header + "target>; rel=up";
+    }
+
+    /**
+     * A base URI with count path segments.
+     */
+    inline std::string dotSegmentsBase(std::size_t count) {
+        std::string base = "https://example.com/";
+        for(std::size_t i = 0; i < count; ++i)
+            base += "a/";
+        return base;
+    }
+
+    /**
+     * A target that lacks its closing ">".
+     */
+    inline std::string unterminatedTarget(std::size_t length) {
+        return "<https://example.com/" + std::string(length, 'a');
+    }
+
+    /**
+     * A title parameter whose quoted string is never closed, containing
+     * escapes and would-be separators.
+     */
+    inline std::string unterminatedQuote(std::size_t length) {
+        std::string header = "<https://example.com/>; rel=next; title=\"";
+        while(header.size() < length)
+            header += "a\\\";b, <c>; ";
+        return header;
+    }
+
+    /**
+     * A link-value followed by length empty parameters.
+     */
+    inline std::string emptyParameters(std::size_t length) {
+        return "<https://example.com/>" + std::string(length, ';') + ", <x>";
+    }
+
+}
+
+#endif //HLH_BENCHMARK_PATHOLOGICAL_H
@@ -0,0 +1,122 @@
+// Benchmarks over adversarial inputs, checking that the time and memory
+// used grow no more than linearly with the size of the input
+
+#include "http-link-header.h"
+#include "harness.h"
+#include "pathological.h"
+
+#include <cstdio>
+#include <string>
+
+namespace {
+
+    /** how much larger the second input of a scaling check is */
+    const std::size_t growth = 4;
+
+    /**
+     * How much more time and allocated memory the second input may take.
+     * Linear growth gives a factor of growth, quadratic growth gives
+     * growth * growth; the margin absorbs timing noise.
+     */
+    const double maxTimeGrowth = 2.0 * growth;
+    const double maxMemoryGrowth = 1.5 * growth;
+
+    /**
+     * Benchmarks fn on make(size) and on make(size * growth), and checks
+     * that the time per call and the bytes allocated per call grow no more
+     * than linearly.
+     *
+     * @param links whether size is the number of links the input contains
+     * @param base if not null, makes the base URI fn resolves against
+     *
+     * @return 1 if the check failed, 0 if it passed or was filtered out
+     */
+    template<typename Make, typename Fn>
+    int checkScaling(hlh_bench::Suite &suite, const std::string &name, std::size_t size, bool links,
+                     Make make, Fn fn, std::string (*base)(std::size_t) = nullptr) {
+        std::size_t before = suite.results().size();
+        for(std::size_t n : {size, size * growth}) {
+            std::string input = make(n);
+            std::string baseUri = base ? base(n) : std::string();
+            suite.run(name + "-" + std::to_string(n), {input.size(), links ? n : 1}, [&] { fn(input, baseUri); });
+        }
+        if(suite.results().size() != before + 2)
+            return 0;
+
+        const hlh_bench::Result &small = suite.results()[before];
+        const hlh_bench::Result &large = suite.results()[before + 1];
+
+        double timeGrowth = small.nsPerCall > 0 ? large.nsPerCall / small.nsPerCall : 0;
+        double memoryGrowth = small.allocatedBytesPerCall > 0
+                              ? large.allocatedBytesPerCall / small.allocatedBytesPerCall
+                              : (large.allocatedBytesPerCall > 0 ? maxMemoryGrowth + 1 : 0);
+        bool ok = timeGrowth <= maxTimeGrowth && memoryGrowth <= maxMemoryGrowth;
+
+        std::printf("%-56s time x%.1f, memory x%.1f for x%zu input: %s\n", ("scaling " + name).c_str(),
+                    timeGrowth, memoryGrowth, growth, ok ? "ok" : "FAILED");
+        return ok ? 0 : 1;
+    }
+
+}
+
+int runPathologicalBenchmarks(hlh_bench::Suite &suite) {
+    using namespace hlh_bench;
+    int failures = 0;
+
+    failures += checkScaling(suite, "pathological/parse/links", 12500, true, manyLinks,
+                             [](const std::string &h, const std::string &) {
+        doNotOptimize(http_link_header::parse(h));
+    });
+    failures += checkScaling(suite, "pathological/parseGroups/links", 12500, true, manyLinks,
+                             [](const std::string &h, const std::string &) {
+        doNotOptimize(http_link_header::parseGroups(h));
+    });
+    failures += checkScaling(suite, "pathological/parse/parameters", 2500, false, manyDistinctParameters,
+                             [](const std::string &h, const std::string &) {
+        doNotOptimize(http_link_header::parse(h));
+    });
+    failures += checkScaling(suite, "pathological/parse/relations", 2500, true, manyRelationTokens,
+                             [](const std::string &h, const std::string &) {
+        doNotOptimize(http_link_header::parse(h));
+    });
+    failures += checkScaling(suite, "pathological/parseGroups/relations", 2500, true, manyRelationTokens,
+                             [](const std::string &h, const std::string &) {
+        doNotOptimize(http_link_header::parseGroups(h));
+    });
+
+    // parse() copies every target attribute into the link of every relation
+    // type, so its output is quadratic here by design; parseGroups() is not.
+    failures += checkScaling(suite, "pathological/parseGroups/relations-and-parameters", 500, true,
+                             manyRelationsAndParameters, [](const std::string &h, const std::string &) {
+        doNotOptimize(http_link_header::parseGroups(h));
+    });
+
+    failures += checkScaling(suite, "pathological/parseQuotedString/escapes", 16384, false, backslashEscapes,
+                             [](const std::string &h, const std::string &) {
+        std::string input = h;
+        doNotOptimize(http_link_header::parseQuotedString(input));
+    });
+    failures += checkScaling(suite, "pathological/parse/escapes", 16384, false,
+                             [](std::size_t n) { return "<x>; title=" + backslashEscapes(n); },
+                             [](const std::string &h, const std::string &) {
+        doNotOptimize(http_link_header::parse(h));
+    });
+    failures += checkScaling(suite, "pathological/parse/dot-segments", 1000, false, dotSegments,
+                             [](const std::string &h, const std::string &base) {
+        doNotOptimize(http_link_header::parse(h, base));
+    }, dotSegmentsBase);
+    failures += checkScaling(suite, "pathological/parse/unterminated-target", 65536, false, unterminatedTarget,
+                             [](const std::string &h, const std::string &) {
+        doNotOptimize(http_link_header::parse(h));
+    });
+    failures += checkScaling(suite, "pathological/parse/unterminated-quote", 65536, false, unterminatedQuote,
+                             [](const std::string &h, const std::string &) {
+        doNotOptimize(http_link_header::parse(h));
+    });
+    failures += checkScaling(suite, "pathological/parse/empty-parameters", 16384, false, emptyParameters,
+                             [](const std::string &h, const std::string &) {
+        doNotOptimize(http_link_header::parse(h));
+    });
+
+    return failures;
+}
@@ -0,0 +1,255 @@
+// Replays captured Link header field values through parse() and reports the
+// latency distribution per header size
+//
+// usage: replay <file> [--recorded [--speed <factor>]] [--repeat <n>]
+//        replay <file> --pipeline <threads> [--repeat <n>]
+//        replay --write-corpus <file>
+//
+// Each line of the file is one Link header field value, optionally preceded
+// by a timestamp in seconds and/or the base URI it is resolved against, each
+// followed by a tab:
+//
+//     [<timestamp>\t][<base URI>\t]<header>
+//
+// By default the headers are parsed as fast as possible. With --recorded they
+// are parsed at the times their timestamps give, relative to the first one,
+// scaled by 1/speed. --write-corpus writes the benchmark corpus in this
+// format, as a starting point.
+//
+// --pipeline streams the file through a Pipeline with that many parse
+// threads instead, and reports its throughput and how often each stage
+// waited. Its input has no timestamps.
+
+#include "http-link-header-parallel.h"
+#include "corpus.h"
+#include "harness.h"
+#include "histogram.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    class Capture {
+    public:
+        /** seconds, or a negative number if the line has no timestamp */
+        double timestamp;
+        std::string baseUri;
+        std::string header;
+    };
+
+    bool isTimestamp(const std::string &field) {
+        if(field.empty())
+            return false;
+        char *end = nullptr;
+        std::strtod(field.c_str(), &end);
+        return end == field.c_str() + field.size();
+    }
+
+    /**
+     * Splits a line into its optional timestamp and base URI and the header.
+     * A field before a tab is taken to be a timestamp if it is a number, and
+     * a base URI if it contains "://" and no "<".
+     */
+    Capture parseLine(const std::string &line) {
+        Capture capture{-1, "", ""};
+        std::size_t start = 0;
+        for(int field = 0; field < 2; ++field) {
+            std::size_t tab = line.find('\t', start);
+            if(tab == std::string::npos)
+                break;
+            std::string value = line.substr(start, tab - start);
+            if(field == 0 && isTimestamp(value))
+                capture.timestamp = std::strtod(value.c_str(), nullptr);
+            else if(capture.baseUri.empty() && value.find("://") != std::string::npos &&
+                    value.find('<') == std::string::npos)
+                capture.baseUri = value;
+            else
+                break;
+            start = tab + 1;
+        }
+        capture.header = line.substr(start);
+        return capture;
+    }
+
+    /** header sizes are reported in these buckets, by upper bound in bytes */
+    const std::size_t sizeBounds[] = {256, 1024, 4096, 16384, 65536, SIZE_MAX};
+    const std::size_t sizeBucketCount = sizeof(sizeBounds) / sizeof(sizeBounds[0]);
+
+    std::size_t sizeBucket(std::size_t size) {
+        std::size_t i = 0;
+        while(size >= sizeBounds[i] && i + 1 < sizeBucketCount)
+            ++i;
+        return i;
+    }
+
+    std::string sizeLabel(std::size_t bucket) {
+        std::size_t low = bucket == 0 ? 0 : sizeBounds[bucket - 1];
+        if(bucket + 1 == sizeBucketCount)
+            return ">= " + std::to_string(low) + " B";
+        return std::to_string(low) + " - " + std::to_string(sizeBounds[bucket] - 1) + " B";
+    }
+
+    void printRow(const std::string &label, const hlh_bench::Histogram &histogram) {
+        std::printf("%-20s %10llu %12llu %12llu %12llu %12llu\n", label.c_str(),
+                    static_cast<unsigned long long>(histogram.count()),
+                    static_cast<unsigned long long>(histogram.percentile(0.5)),
+                    static_cast<unsigned long long>(histogram.percentile(0.99)),
+                    static_cast<unsigned long long>(histogram.percentile(0.999)),
+                    static_cast<unsigned long long>(histogram.max()));
+    }
+
+    int replayPipeline(const char *path, unsigned threads, long repeat) {
+        http_link_header::PipelineOptions options;
+        options.workers = threads;
+        http_link_header::Pipeline pipeline(options);
+
+        std::uint64_t links = 0;
+        http_link_header::PipelineStats total{{0, 0}, {0, 0}, {0, 0}, 0, 0};
+        for(long round = 0; round < repeat; ++round) {
+            std::ifstream in(path);
+            if(!in) {
+                std::fprintf(stderr, "cannot read %s\n", path);
+                return 2;
+            }
+            pipeline.run(in, [&](http_link_header::PipelineRecord &record) { links += record.result.links.size(); });
+
+            auto stats = pipeline.stats();
+            for(auto stage : {&http_link_header::PipelineStats::read, &http_link_header::PipelineStats::parse,
+                              &http_link_header::PipelineStats::sink}) {
+                (total.*stage).items += (stats.*stage).items;
+                (total.*stage).stalls += (stats.*stage).stalls;
+            }
+            total.bytes += stats.bytes;
+            total.seconds += stats.seconds;
+        }
+
+        std::printf("piped %llu lines x %ld (%llu links) in %.3f s with %u parse threads: %.0f lines/s, %.1f MB/s\n",
+                    static_cast<unsigned long long>(total.read.items / static_cast<std::uint64_t>(repeat)), repeat,
+                    static_cast<unsigned long long>(links), total.seconds, threads,
+                    static_cast<double>(total.sink.items) / total.seconds,
+                    static_cast<double>(total.bytes) / total.seconds / 1e6);
+        std::printf("%-8s %12s %12s\n", "stage", "lines", "stalls");
+        std::printf("%-8s %12llu %12llu\n", "read", static_cast<unsigned long long>(total.read.items),
+                    static_cast<unsigned long long>(total.read.stalls));
+        std::printf("%-8s %12llu %12llu\n", "parse", static_cast<unsigned long long>(total.parse.items),
+                    static_cast<unsigned long long>(total.parse.stalls));
+        std::printf("%-8s %12llu %12llu\n", "sink", static_cast<unsigned long long>(total.sink.items),
+                    static_cast<unsigned long long>(total.sink.stalls));
+        return 0;
+    }
+
+    int writeCorpus(const char *path) {
+        std::ofstream out(path);
+        for(const auto &entry : hlh_bench::corpus()) {
+            if(!entry.baseUri.empty())
+                out << entry.baseUri << '\t';
+            out << entry.header << '\n';
+        }
+        if(!out) {
+            std::fprintf(stderr, "cannot write %s\n", path);
+            return 2;
+        }
+        return 0;
+    }
+
+}
+
+int main(int argc, char *argv[]) {
+    typedef std::chrono::steady_clock Clock;
+
+    const char *path = nullptr;
+    bool recorded = false;
+    double speed = 1;
+    long repeat = 1;
+    long pipelineThreads = 0;
+    bool usage = false;
+
+    for(int i = 1; i < argc; ++i) {
+        if(std::strcmp(argv[i], "--write-corpus") == 0 && i + 1 < argc)
+            return writeCorpus(argv[i + 1]);
+        else if(std::strcmp(argv[i], "--recorded") == 0)
+            recorded = true;
+        else if(std::strcmp(argv[i], "--speed") == 0 && i + 1 < argc)
+            speed = std::atof(argv[++i]);
+        else if(std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+            repeat = std::atol(argv[++i]);
+        else if(std::strcmp(argv[i], "--pipeline") == 0 && i + 1 < argc)
+            pipelineThreads = std::atol(argv[++i]);
+        else if(argv[i][0] != '-' && !path)
+            path = argv[i];
+        else
+            usage = true;
+    }
+    if(usage || !path || speed <= 0 || repeat < 1 || pipelineThreads < 0 || (recorded && pipelineThreads)) {
+        std::fprintf(stderr, "usage: %s <file> [--recorded [--speed <factor>]] [--repeat <n>]\n"
+                             "       %s <file> --pipeline <threads> [--repeat <n>]\n"
+                             "       %s --write-corpus <file>\n", argv[0], argv[0], argv[0]);
+        return 2;
+    }
+    if(pipelineThreads)
+        return replayPipeline(path, static_cast<unsigned>(pipelineThreads), repeat);
+
+    std::ifstream in(path);
+    if(!in) {
+        std::fprintf(stderr, "cannot read %s\n", path);
+        return 2;
+    }
+    std::vector<Capture> captures;
+    std::string line;
+    while(std::getline(in, line)) {
+        if(!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if(!line.empty())
+            captures.push_back(parseLine(line));
+    }
+    if(captures.empty()) {
+        std::fprintf(stderr, "%s contains no headers\n", path);
+        return 2;
+    }
+
+    std::vector<hlh_bench::Histogram> histograms(sizeBucketCount);
+    std::size_t links = 0;
+
+    auto replayStart = Clock::now();
+    double firstTimestamp = captures.front().timestamp;
+    for(long round = 0; round < repeat; ++round) {
+        auto roundStart = Clock::now();
+        for(const auto &capture : captures) {
+            if(recorded && capture.timestamp >= 0 && firstTimestamp >= 0) {
+                std::chrono::duration<double> offset((capture.timestamp - firstTimestamp) / speed);
+                std::this_thread::sleep_until(roundStart + std::chrono::duration_cast<Clock::duration>(offset));
+            }
+
+            auto start = Clock::now();
+            std::vector<http_link_header::Link> parsed = http_link_header::parse(capture.header, capture.baseUri);
+            auto elapsed = Clock::now() - start;
+            hlh_bench::doNotOptimize(parsed);
+
+            links += parsed.size();
+            histograms[sizeBucket(capture.header.size())].record(static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+    std::chrono::duration<double> total = Clock::now() - replayStart;
+
+    std::printf("replayed %zu headers x %ld (%zu links) in %.3f s\n", captures.size(), repeat, links,
+                total.count());
+    std::printf("%-20s %10s %12s %12s %12s %12s\n", "header size", "calls", "p50 ns", "p99 ns", "p99.9 ns", "max ns");
+    hlh_bench::Histogram all;
+    for(std::size_t i = 0; i < sizeBucketCount; ++i) {
+        if(histograms[i].count() != 0)
+            printRow(sizeLabel(i), histograms[i]);
+        all.add(histograms[i]);
+    }
+    printRow("all", all);
+
+    return 0;
+}
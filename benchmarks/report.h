@@ -0,0 +1,127 @@
+// Reading and writing benchmark results as JSON
+
+#ifndef HLH_BENCHMARK_REPORT_H
+#define HLH_BENCHMARK_REPORT_H
+
+#include "harness.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace hlh_bench {
+
+    inline std::string jsonString(const std::string &s) {
+        std::string out = "\"";
+        for(char c : s) {
+            if(c == '"' || c == '\\')
+                out += '\\';
+            out += c;
+        }
+        return out + '"';
+    }
+
+    /**
+     * Writes results, and their comparison against a baseline if there is
+     * one, as a JSON document.
+     */
+    inline bool writeResults(const std::string &path, const std::vector<Result> &results,
+                             const std::map<std::string, double> &baseline) {
+        std::ofstream out(path);
+        if(!out)
+            return false;
+
+        out << "{\n  \"benchmarks\": [";
+        for(std::size_t i = 0; i < results.size(); ++i) {
+            const Result &r = results[i];
+            out << (i ? ",\n" : "\n") << "    {\"name\": " << jsonString(r.name)
+                << ", \"iterations\": " << r.iterations
+                << ", \"ns_per_call\": " << r.nsPerCall
+                << ", \"ns_per_link\": " << r.nsPerLink()
+                << ", \"bytes_per_second\": " << r.bytesPerSecond()
+                << ", \"allocations_per_call\": " << r.allocationsPerCall
+                << ", \"allocated_bytes_per_call\": " << r.allocatedBytesPerCall;
+            for(int event = 0; event < Counters::EventCount; ++event) {
+                auto e = static_cast<Counters::Event>(event);
+                if(r.countersPerCall[event] < 0)
+                    continue;
+                if(r.work.bytes)
+                    out << ", \"" << Counters::name(e) << "_per_byte\": " << r.counterPer(e, r.work.bytes);
+                if(r.work.links)
+                    out << ", \"" << Counters::name(e) << "_per_link\": " << r.counterPer(e, r.work.links);
+            }
+            auto found = baseline.find(r.name);
+            if(found != baseline.end())
+                out << ", \"baseline_ns_per_call\": " << found->second
+                    << ", \"ratio\": " << r.nsPerCall / found->second;
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+        return static_cast<bool>(out);
+    }
+
+    /**
+     * Reads the "name" and "ns_per_call" members of the objects in a file
+     * written by writeResults().
+     */
+    inline bool readBaseline(const std::string &path, std::map<std::string, double> &baseline) {
+        std::ifstream in(path);
+        if(!in)
+            return false;
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        const std::string json = buffer.str();
+
+        std::string::size_type pos = 0;
+        while((pos = json.find('{', pos + 1)) != std::string::npos) {
+            std::string::size_type close = json.find('}', pos);
+            if(close == std::string::npos)
+                break;
+            std::string object = json.substr(pos, close - pos);
+
+            std::string::size_type name = object.find("\"name\"");
+            std::string::size_type value = object.find("\"ns_per_call\"");
+            if(name == std::string::npos || value == std::string::npos)
+                continue;
+
+            std::string::size_type begin = object.find('"', object.find(':', name) + 1);
+            std::string::size_type end = object.find('"', begin + 1);
+            if(begin == std::string::npos || end == std::string::npos)
+                continue;
+            double ns = std::strtod(object.c_str() + object.find(':', value) + 1, nullptr);
+            if(ns > 0)
+                baseline[object.substr(begin + 1, end - begin - 1)] = ns;
+        }
+        return true;
+    }
+
+    /**
+     * Compares results against a baseline and prints the benchmarks that are
+     * more than tolerance (a fraction, like 0.3 for 30%) slower.
+     *
+     * @return the number of regressions
+     */
+    inline int countRegressions(const std::vector<Result> &results,
+                                const std::map<std::string, double> &baseline, double tolerance) {
+        int regressions = 0;
+        for(const Result &r : results) {
+            auto found = baseline.find(r.name);
+            if(found == baseline.end())
+                continue;
+            double ratio = r.nsPerCall / found->second;
+            if(ratio > 1.0 + tolerance) {
+                std::printf("REGRESSION %s: %.1f ns/call, baseline %.1f ns/call (%+.0f%%)\n",
+                            r.name.c_str(), r.nsPerCall, found->second, (ratio - 1.0) * 100);
+                ++regressions;
+            }
+        }
+        return regressions;
+    }
+
+}
+
+#endif //HLH_BENCHMARK_REPORT_H
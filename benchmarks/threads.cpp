@@ -0,0 +1,245 @@
+// Measures how the throughput of parse() scales with the number of threads
+//
+// usage: threads [--max-threads <n>] [--seconds <s>]
+//
+// For 1, 2, 4, ... up to max-threads threads (default: the number of
+// hardware threads), every thread parses the benchmark corpus over and over
+// for the given time (default 1 second). In "shared" runs all threads parse
+// the same strings; in "private" runs each thread has its own copies. The
+// speedup is relative to one thread, and efficiency is the speedup divided
+// by the number of threads, 1.0 meaning linear scaling.
+//
+// "batch" runs parse the same inputs, many times over, with parse_batch()
+// on a ThreadPool of that many threads. "large" runs parse the corpus joined
+// into a single header field of about 256 KB with parse_parallel().
+//
+// Every result is checked against the single-threaded result; the exit
+// status is 1 if any differs.
+
+#include "http-link-header-parallel.h"
+#include "corpus.h"
+#include "harness.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    typedef std::chrono::steady_clock Clock;
+
+    class Input {
+    public:
+        std::string header;
+        std::string baseUri;
+        std::vector<http_link_header::Link> expected;
+    };
+
+    bool same(const std::vector<http_link_header::Link> &a, const std::vector<http_link_header::Link> &b) {
+        if(a != b)
+            return false;
+        for(std::size_t i = 0; i < a.size(); ++i) {
+            if(!a[i].sameRelation(b[i]))
+                return false;
+        }
+        return true;
+    }
+
+    class Run {
+    public:
+        double callsPerSecond;
+        std::uint64_t mismatches;
+    };
+
+    /**
+     * Parses inputs from threads threads for seconds seconds. Each thread
+     * keeps its counts in locals and publishes them once at the end, so
+     * the measurement itself shares no cache lines.
+     */
+    Run run(const std::vector<Input> &shared, unsigned threads, double seconds, bool privateInputs) {
+        std::atomic<bool> go(false);
+        std::atomic<bool> stop(false);
+        std::atomic<std::uint64_t> calls(0);
+        std::atomic<std::uint64_t> mismatches(0);
+        std::atomic<unsigned> ready(0);
+
+        std::vector<std::thread> workers;
+        for(unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                std::vector<Input> copies;
+                if(privateInputs)
+                    copies = shared;
+                const std::vector<Input> &inputs = privateInputs ? copies : shared;
+
+                ++ready;
+                while(!go.load())
+                    std::this_thread::yield();
+
+                std::uint64_t localCalls = 0;
+                std::uint64_t localMismatches = 0;
+                while(!stop.load(std::memory_order_relaxed)) {
+                    for(const auto &input : inputs) {
+                        auto links = http_link_header::parse(input.header, input.baseUri);
+                        if(!same(links, input.expected))
+                            ++localMismatches;
+                        hlh_bench::doNotOptimize(links);
+                        ++localCalls;
+                    }
+                }
+                calls += localCalls;
+                mismatches += localMismatches;
+            });
+        }
+
+        while(ready.load() != threads)
+            std::this_thread::yield();
+        auto start = Clock::now();
+        go.store(true);
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        stop.store(true);
+        for(auto &worker : workers)
+            worker.join();
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+
+        return Run{static_cast<double>(calls.load()) / elapsed.count(), mismatches.load()};
+    }
+
+    /**
+     * Parses inputs with parse_batch() on a pool of threads threads for
+     * seconds seconds, in batches of many copies of inputs.
+     */
+    Run runBatch(const std::vector<Input> &inputs, unsigned threads, double seconds) {
+        const std::size_t copies = 256;
+        std::vector<http_link_header::HeaderRef> batch;
+        for(std::size_t c = 0; c < copies; ++c) {
+            for(const auto &input : inputs)
+                batch.push_back(http_link_header::HeaderRef(input.header, input.baseUri));
+        }
+        std::vector<http_link_header::ParseResult> results(batch.size());
+
+        http_link_header::ThreadPool pool(threads);
+        std::uint64_t calls = 0;
+        std::uint64_t mismatches = 0;
+        auto start = Clock::now();
+        std::chrono::duration<double> elapsed(0);
+        while(elapsed.count() < seconds) {
+            http_link_header::parse_batch(batch.data(), batch.size(), results.data(), pool);
+            for(std::size_t i = 0; i < results.size(); ++i) {
+                if(!same(results[i].links, inputs[i % inputs.size()].expected))
+                    ++mismatches;
+            }
+            calls += batch.size();
+            elapsed = Clock::now() - start;
+        }
+
+        return Run{static_cast<double>(calls) / elapsed.count(), mismatches};
+    }
+
+    /**
+     * Parses the large header field input with parse_parallel() on a pool of
+     * threads threads for seconds seconds.
+     */
+    Run runLarge(const Input &input, const http_link_header::ParseOptions &options, unsigned threads,
+                 double seconds) {
+        http_link_header::ThreadPool pool(threads);
+        std::uint64_t calls = 0;
+        std::uint64_t mismatches = 0;
+        auto start = Clock::now();
+        std::chrono::duration<double> elapsed(0);
+        while(elapsed.count() < seconds) {
+            auto result = http_link_header::parse_parallel(input.header, input.baseUri, pool, options);
+            if(!same(result.links, input.expected))
+                ++mismatches;
+            hlh_bench::doNotOptimize(result);
+            ++calls;
+            elapsed = Clock::now() - start;
+        }
+
+        return Run{static_cast<double>(calls) / elapsed.count(), mismatches};
+    }
+
+}
+
+int main(int argc, char *argv[]) {
+    unsigned maxThreads = std::thread::hardware_concurrency();
+    double seconds = 1;
+
+    for(int i = 1; i < argc; ++i) {
+        if(std::strcmp(argv[i], "--max-threads") == 0 && i + 1 < argc)
+            maxThreads = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if(std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+            seconds = std::atof(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: %s [--max-threads <n>] [--seconds <s>]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(maxThreads == 0)
+        maxThreads = 1;
+
+    std::vector<Input> inputs;
+    for(const auto &entry : hlh_bench::corpus())
+        inputs.push_back({entry.header, entry.baseUri, http_link_header::parse(entry.header, entry.baseUri)});
+
+    // the corpus has malformed headers, which are skipped
+    http_link_header::ParseOptions largeOptions;
+    largeOptions.recover = true;
+    Input large;
+    large.baseUri = "https://example.com/a/b";
+    while(large.header.size() < 256 * 1024) {
+        for(const auto &input : inputs)
+            large.header += (large.header.empty() ? "" : ", ") + input.header;
+    }
+    large.expected = http_link_header::tryParse(large.header, large.baseUri, largeOptions).links;
+
+    std::vector<unsigned> counts;
+    for(unsigned threads = 1; threads < maxThreads; threads *= 2)
+        counts.push_back(threads);
+    counts.push_back(maxThreads);
+
+    std::printf("%d hardware threads, %.1f s per run\n", static_cast<int>(std::thread::hardware_concurrency()),
+                seconds);
+    std::printf("%8s %16s %8s %10s %16s %8s %10s %16s %8s %10s %16s %8s %10s\n", "threads", "shared calls/s",
+                "speedup", "efficiency", "private calls/s", "speedup", "efficiency", "batch calls/s", "speedup",
+                "efficiency", "large calls/s", "speedup", "efficiency");
+
+    std::uint64_t mismatches = 0;
+    double sharedBase = 0;
+    double privateBase = 0;
+    double batchBase = 0;
+    double largeBase = 0;
+    for(unsigned threads : counts) {
+        Run shared = run(inputs, threads, seconds, false);
+        Run copies = run(inputs, threads, seconds, true);
+        Run batch = runBatch(inputs, threads, seconds);
+        Run parallel = runLarge(large, largeOptions, threads, seconds);
+        mismatches += shared.mismatches + copies.mismatches + batch.mismatches + parallel.mismatches;
+        if(threads == 1) {
+            sharedBase = shared.callsPerSecond;
+            privateBase = copies.callsPerSecond;
+            batchBase = batch.callsPerSecond;
+            largeBase = parallel.callsPerSecond;
+        }
+        double sharedSpeedup = shared.callsPerSecond / sharedBase;
+        double privateSpeedup = copies.callsPerSecond / privateBase;
+        double batchSpeedup = batch.callsPerSecond / batchBase;
+        double largeSpeedup = parallel.callsPerSecond / largeBase;
+        std::printf("%8u %16.0f %8.2f %10.2f %16.0f %8.2f %10.2f %16.0f %8.2f %10.2f %16.1f %8.2f %10.2f\n",
+                    threads, shared.callsPerSecond, sharedSpeedup, sharedSpeedup / threads,
+                    copies.callsPerSecond, privateSpeedup, privateSpeedup / threads,
+                    batch.callsPerSecond, batchSpeedup, batchSpeedup / threads,
+                    parallel.callsPerSecond, largeSpeedup, largeSpeedup / threads);
+    }
+
+    if(mismatches != 0) {
+        std::fprintf(stderr, "%llu results differed from the single-threaded results\n",
+                     static_cast<unsigned long long>(mismatches));
+        return 1;
+    }
+    return 0;
+}
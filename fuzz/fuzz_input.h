@@ -0,0 +1,30 @@
+// Helpers shared by the libFuzzer targets
+
+#ifndef HLH_FUZZ_INPUT_H
+#define HLH_FUZZ_INPUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace hlh_fuzz {
+
+    /**
+     * Splits fuzzer input into the part before the first newline and the
+     * rest. Without a newline, first is empty and rest is the whole input.
+     */
+    inline void splitFirstLine(const std::uint8_t *data, std::size_t size, std::string &first, std::string &rest) {
+        std::string input(reinterpret_cast<const char*>(data), size);
+        std::size_t newline = input.find('\n');
+        if(newline == std::string::npos) {
+            first.clear();
+            rest = std::move(input);
+            return;
+        }
+        first = input.substr(0, newline);
+        rest = input.substr(newline + 1);
+    }
+
+}
+
+#endif //HLH_FUZZ_INPUT_H
@@ -0,0 +1,34 @@
+// libFuzzer target for parse(), parseGroups() and extract_pagination()
+//
+// The input is a Link header field value, optionally preceded by a base URI
+// and a newline.
+
+#include "http-link-header.h"
+#include "fuzz_input.h"
+
+#include <cstdlib>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size) {
+    std::string baseUri;
+    std::string header;
+    hlh_fuzz::splitFirstLine(data, size, baseUri, header);
+
+    auto links = http_link_header::parse(header, baseUri);
+    auto groups = http_link_header::parseGroups(header, baseUri);
+
+    // the grouped output must expand to the same links
+    if(http_link_header::expand(groups) != links)
+        std::abort();
+
+    // a "next" pagination link is one of the links parse() finds
+    auto pagination = http_link_header::extract_pagination(header);
+    if(pagination.next.found) {
+        bool found = false;
+        for(const auto &link : http_link_header::parse(header))
+            found = found || link.linkRelation == "next";
+        if(!found)
+            std::abort();
+    }
+
+    return 0;
+}
@@ -0,0 +1,26 @@
+// libFuzzer target for parseParameters()
+
+#include "http-link-header.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size) {
+    const std::string original(reinterpret_cast<const char*>(data), size);
+    std::string input = original;
+
+    auto parameters = http_link_header::parseParameters(input);
+
+    // only a prefix of the input is consumed
+    if(input.size() > original.size() ||
+       original.compare(original.size() - input.size(), input.size(), input) != 0)
+        std::abort();
+
+    for(const auto &parameter : parameters) {
+        if(parameter.id != http_link_header::knownParameter(parameter.name))
+            std::abort();
+    }
+
+    return 0;
+}
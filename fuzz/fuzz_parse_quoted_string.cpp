@@ -0,0 +1,21 @@
+// libFuzzer target for parseQuotedString()
+
+#include "http-link-header.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size) {
+    const std::string original(reinterpret_cast<const char*>(data), size);
+    std::string input = original;
+
+    std::string output = http_link_header::parseQuotedString(input);
+
+    // unescaping never grows the string, and only a prefix is consumed
+    if(output.size() + input.size() > original.size() ||
+       original.compare(original.size() - input.size(), input.size(), input) != 0)
+        std::abort();
+
+    return 0;
+}
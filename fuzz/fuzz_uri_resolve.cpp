@@ -0,0 +1,17 @@
+// libFuzzer target for uri::resolve()
+//
+// The input is a base URI, a newline and the URI reference to resolve.
+
+#include "http-link-header.h"
+#include "fuzz_input.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size) {
+    std::string baseUri;
+    std::string reference;
+    hlh_fuzz::splitFirstLine(data, size, baseUri, reference);
+
+    std::string result;
+    http_link_header::uri::resolve(&baseUri, &reference, &result);
+
+    return 0;
+}
@@ -0,0 +1,999 @@
+#ifndef HTTP_LINK_HEADER_PARALLEL_H
+#define HTTP_LINK_HEADER_PARALLEL_H
+
+// Parsing Link header fields on several threads: ThreadPool, parse_batch(),
+// parse_parallel(), parse_async() and Pipeline. These start threads, so they
+// are kept out of http-link-header.h and need the platform's thread library.
+
+#include "http-link-header.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <future>
+#include <exception>
+#include <istream>
+#include <type_traits>
+
+
+namespace http_link_header {
+
+    /**
+     * A fixed set of threads that run loops in parallel, see parallelFor().
+     *
+     * The iterations of a loop are split into one range per thread. Each
+     * thread takes small blocks from the front of its own range and, once it
+     * runs out, steals half of what is left of another thread's range, so
+     * threads that get the slow iterations are helped by the others.
+     */
+    class ThreadPool {
+    public:
+        /**
+         * @param threads the number of threads to run loops on, including
+         *        the thread that calls parallelFor(); 0 means one per
+         *        hardware thread
+         */
+        explicit ThreadPool(unsigned threads = 0)
+                : generation_(0), stop_(false), busy_(0), run_(nullptr), context_(nullptr), grain_(1) {
+            if(threads == 0)
+                threads = std::max(1u, std::thread::hardware_concurrency());
+            for(unsigned i = 0; i < threads; ++i)
+                queues_.emplace_back(new Queue());
+            for(unsigned i = 1; i < threads; ++i)
+                threads_.emplace_back([this, i] { workerLoop(i); });
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            wake_.notify_all();
+            for(auto &thread : threads_)
+                thread.join();
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /** the number of threads that run loops, including the calling one */
+        unsigned size() const {
+            return static_cast<unsigned>(queues_.size());
+        }
+
+        /**
+         * Calls fn(begin, end) for ranges that together cover [0, count)
+         * once, on the threads of the pool and the calling thread, and
+         * returns when all are done. Loops from several threads run one
+         * after another.
+         *
+         * @param fn must not throw, nor call parallelFor() of this pool
+         */
+        template<typename Fn>
+        void parallelFor(std::size_t count, Fn &&fn) {
+            if(count == 0)
+                return;
+            std::lock_guard<std::mutex> submit(submit_);
+            if(threads_.empty() || count == 1) {
+                fn(std::size_t(0), count);
+                return;
+            }
+
+            run_ = [](void *context, std::size_t begin, std::size_t end) {
+                (*static_cast<typename std::remove_reference<Fn>::type*>(context))(begin, end);
+            };
+            context_ = const_cast<void*>(static_cast<const void*>(&fn));
+            // blocks small enough for a few steals per thread
+            grain_ = std::max<std::size_t>(1, count / (queues_.size() * 16));
+
+            std::size_t begin = 0;
+            for(std::size_t i = 0; i < queues_.size(); ++i) {
+                std::size_t end = count * (i + 1) / queues_.size();
+                std::lock_guard<std::mutex> lock(queues_[i]->mutex);
+                queues_[i]->begin = begin;
+                queues_[i]->end = end;
+                begin = end;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ++generation_;
+                busy_ = static_cast<unsigned>(threads_.size());
+            }
+            wake_.notify_all();
+
+            work(0);
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_.wait(lock, [this] { return busy_ == 0; });
+        }
+
+    private:
+        /** the iterations [begin, end) that one thread has left to run */
+        class Queue {
+        public:
+            Queue() : begin(0), end(0) {}
+
+            std::mutex mutex;
+            std::size_t begin;
+            std::size_t end;
+        };
+
+        void workerLoop(unsigned slot) {
+            std::uint64_t seen = 0;
+            for(;;) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                    if(stop_)
+                        return;
+                    seen = generation_;
+                }
+
+                work(slot);
+
+                std::lock_guard<std::mutex> lock(mutex_);
+                if(--busy_ == 0)
+                    done_.notify_one();
+            }
+        }
+
+        /** runs blocks of the own range, then of stolen ones, until there are none */
+        void work(unsigned slot) {
+            std::size_t begin, end;
+            for(;;) {
+                if(take(slot, begin, end))
+                    run_(context_, begin, end);
+                else if(!steal(slot))
+                    return;
+            }
+        }
+
+        bool take(unsigned slot, std::size_t &begin, std::size_t &end) {
+            Queue &queue = *queues_[slot];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if(queue.begin == queue.end)
+                return false;
+            begin = queue.begin;
+            end = std::min(queue.end, queue.begin + grain_);
+            queue.begin = end;
+            return true;
+        }
+
+        /** moves the back half of another thread's range into the own queue */
+        bool steal(unsigned slot) {
+            for(std::size_t i = 1; i < queues_.size(); ++i) {
+                Queue &victim = *queues_[(slot + i) % queues_.size()];
+                std::size_t begin, end;
+                {
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+                    if(victim.begin == victim.end)
+                        continue;
+                    end = victim.end;
+                    begin = end - (end - victim.begin + 1) / 2;
+                    victim.end = begin;
+                }
+                Queue &own = *queues_[slot];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                own.begin = begin;
+                own.end = end;
+                return true;
+            }
+            return false;
+        }
+
+        std::vector<std::unique_ptr<Queue>> queues_;
+        std::vector<std::thread> threads_;
+
+        std::mutex submit_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable done_;
+        std::uint64_t generation_;
+        bool stop_;
+        unsigned busy_;
+
+        // the loop being run
+        void (*run_)(void *context, std::size_t begin, std::size_t end);
+        void *context_;
+        std::size_t grain_;
+    };
+
+    /**
+     * A Link header field to parse with parse_batch(), and the URI to resolve
+     * its relative references against. Both are views, so the strings must
+     * outlive the call.
+     */
+    class HeaderRef {
+    public:
+        HeaderRef() : header(), baseUri() {}
+
+        HeaderRef(StringView headerField, // NOLINT(google-explicit-constructor)
+                  StringView headerBaseUri = StringView())
+                : header(headerField), baseUri(headerBaseUri) {}
+
+        StringView header;
+        StringView baseUri;
+    };
+
+    /**
+     * Parses many independent Link header fields like tryParse(), spread
+     * over the threads of pool.
+     *
+     * @param headers the header fields to parse and their base URIs
+     * @param count the number of header fields
+     * @param results where to write the result of each header field, count
+     *        of them; their storage is reused
+     * @param pool the threads to parse on
+     * @param options the options for each header field
+     */
+    inline void parse_batch(const HeaderRef *headers, std::size_t count, ParseResult *results, ThreadPool &pool,
+                            const ParseOptions &options = ParseOptions()) {
+        pool.parallelFor(count, [&](std::size_t begin, std::size_t end) {
+            ParseContext context;
+            for(std::size_t i = begin; i < end; ++i)
+                context.parse(headers[i].header, headers[i].baseUri, options, results[i]);
+        });
+    }
+
+    /**
+     * Parses many independent Link header fields like tryParse(), spread
+     * over the threads of pool.
+     *
+     * @param headers the header fields to parse and their base URIs
+     * @param pool the threads to parse on
+     * @param options the options for each header field
+     *
+     * @return the result of each header field, in the same order
+     */
+    inline std::vector<ParseResult> parse_batch(const std::vector<HeaderRef> &headers, ThreadPool &pool,
+                                                const ParseOptions &options = ParseOptions()) {
+        std::vector<ParseResult> results(headers.size());
+        parse_batch(headers.data(), headers.size(), results.data(), pool, options);
+        return results;
+    }
+
+    namespace detail {
+
+        /** the smallest segment that parse_parallel() parses on a thread of its own */
+        constexpr std::size_t minSegmentSize = 4096;
+
+        /**
+         * A link-value that parse_parallel() parsed ahead of the serial
+         * parse, with what parseLinkValue() gave for it.
+         */
+        class SpeculativeLinkValue {
+        public:
+            SpeculativeLinkValue() : start(nullptr), next(nullptr), parsed(false), error(ParseError::None), group() {}
+
+            const char *start;
+            const char *next;
+            bool parsed;
+            ParseError error;
+            LinkGroup group;
+        };
+
+        /**
+         * Parses segments of a field value in parallel, each from a comma
+         * that is not in a quoted string or a target, as if a link-value
+         * started there. The serial parse then takes over each link-value it
+         * reaches that was parsed at the same position and parses the others
+         * itself, so where a segment does not start a link-value after all,
+         * e.g. at a comma in a malformed one, the result is still the same.
+         */
+        class SpeculativeParser {
+        public:
+            SpeculativeParser(const std::string &parserBaseUri, const ParseLimits &parserLimits)
+                    : baseUri(parserBaseUri), limits(parserLimits), window(nullptr), starts(), segments() {}
+
+            /**
+             * Splits [begin, windowEnd) into segments of at least segmentSize
+             * bytes and parses them on pool.
+             */
+            void speculate(const char *begin, const char *windowEnd, std::size_t segmentSize,
+                           const ParseOptions &options, ThreadPool &pool) {
+                window = windowEnd;
+                std::vector<const char*> found(1, begin);
+                for(const char *p = begin; (p = findNextLinkValue(p, window)) != window;) {
+                    ++p;
+                    if(static_cast<std::size_t>(p - found.back()) >= segmentSize)
+                        found.push_back(p);
+                }
+                // only set starts once there is a segment for each
+                segments.resize(found.size());
+                starts.swap(found);
+                pool.parallelFor(starts.size(), [&](std::size_t first, std::size_t last) {
+                    for(std::size_t i = first; i < last; ++i)
+                        parseSegment(i, options);
+                });
+            }
+
+            bool operator()(const char *&p, const char *end, LinkGroup &group, ParseError &error) {
+                SpeculativeLinkValue *value = end == window ? find(p) : nullptr;
+                if(!value)
+                    return parseLinkValue(p, end, baseUri, limits, group, error);
+                p = value->next;
+                error = value->error;
+                group = std::move(value->group);
+                return value->parsed;
+            }
+
+        private:
+            /**
+             * Parses the link-values from the start of segment i until one
+             * reaches the next segment, continuing after malformed ones like
+             * parseLinkValues() does.
+             */
+            void parseSegment(std::size_t i, const ParseOptions &options) noexcept {
+                const char *p = starts[i];
+                const char *limit = i + 1 < starts.size() ? starts[i + 1] : window;
+                const ParseBudget &budget = options.budget;
+                bool timed = budget.deadline != std::chrono::steady_clock::time_point::max();
+#ifdef HLH_EXCEPTIONS
+                try {
+#endif
+                    while(p < limit && !(timed && std::chrono::steady_clock::now() >= budget.deadline) &&
+                          !(options.cancelled && options.cancelled->load(std::memory_order_relaxed))) {
+                        SpeculativeLinkValue value;
+                        value.start = p;
+                        value.next = p;
+                        value.parsed = parseLinkValue(value.next, window, baseUri, limits, value.group, value.error);
+                        segments[i].push_back(std::move(value));
+                        const SpeculativeLinkValue &last = segments[i].back();
+                        if(last.parsed) {
+                            p = last.next;
+                            continue;
+                        }
+
+                        bool malformed = last.error == ParseError::ExpectedTarget ||
+                                         last.error == ParseError::UnterminatedTarget;
+                        if(!malformed || !options.recover)
+                            break;
+                        const char *comma = findNextLinkValue(last.next, window);
+                        if(comma == window)
+                            break;
+                        p = comma + 1;
+                    }
+#ifdef HLH_EXCEPTIONS
+                } catch(...) {
+                    // the serial parse parses the rest of the segment
+                }
+#endif
+            }
+
+            /** @return the link-value parsed at p, if there is one */
+            SpeculativeLinkValue* find(const char *p) {
+                auto segment = std::upper_bound(starts.begin(), starts.end(), p);
+                if(segment == starts.begin())
+                    return nullptr;
+                auto &values = segments[static_cast<std::size_t>(segment - starts.begin() - 1)];
+                auto value = std::lower_bound(values.begin(), values.end(), p,
+                                              [](const SpeculativeLinkValue &v, const char *start) {
+                                                  return v.start < start;
+                                              });
+                return value != values.end() && value->start == p ? &*value : nullptr;
+            }
+
+            const std::string &baseUri;
+            const ParseLimits &limits;
+            const char *window;
+            std::vector<const char*> starts;
+            std::vector<std::vector<SpeculativeLinkValue>> segments;
+        };
+
+    }
+
+    /**
+     * Parses a single large Link header field like tryParse(), parsing and
+     * resolving its link-values on the threads of pool.
+     *
+     * A quick pass over the field value finds the commas that are not in a
+     * quoted string or a target and splits it there into segments, which are
+     * parsed in parallel. A serial pass then joins their link-values in
+     * order, parsing itself wherever a segment did not start a link-value,
+     * so the result is always that of tryParse().
+     *
+     * @param linkHeaderField string containing the value of a Link header field
+     * @param baseUri the URI to resolve relative references against
+     * @param pool the threads to parse on; must not be running a loop on the calling thread
+     * @param options the options, see ParseOptions
+     * @param minSegmentBytes the smallest segment to parse on a thread of its
+     *        own; smaller field values are parsed on the calling thread only
+     */
+    inline ParseResult parse_parallel(const std::string &linkHeaderField, const std::string &baseUri,
+                                      ThreadPool &pool, const ParseOptions &options = ParseOptions(),
+                                      std::size_t minSegmentBytes = detail::minSegmentSize) noexcept {
+        ParseResult result;
+        detail::SpeculativeParser parser(baseUri, options.limits);
+
+        const char *begin = linkHeaderField.data();
+        std::size_t size = std::min(linkHeaderField.size(), options.budget.maxBytes);
+        // a few segments per thread, for the threads that finish early to take over
+        std::size_t segmentSize = std::max(minSegmentBytes, size / (pool.size() * 4));
+        if(pool.size() > 1 && size >= 2 * segmentSize && linkHeaderField.size() <= options.limits.maxHeaderBytes) {
+#ifdef HLH_EXCEPTIONS
+            try {
+#endif
+                parser.speculate(begin, begin + size, segmentSize, options, pool);
+#ifdef HLH_EXCEPTIONS
+            } catch(...) {
+                // whatever was not parsed ahead the serial parse parses itself
+            }
+#endif
+        }
+
+        detail::tryParseInto(linkHeaderField, options, parser, result);
+        return result;
+    }
+
+    /**
+     * Cancels parse_async(). Copies share their state, so cancelling one
+     * cancels all.
+     */
+    class CancellationToken {
+    public:
+        CancellationToken() : cancelled_(std::make_shared<std::atomic<bool>>(false)) {}
+
+        /** makes parsing stop before its next link-value, with ParseError::Cancelled */
+        void cancel() const noexcept {
+            cancelled_->store(true, std::memory_order_relaxed);
+        }
+
+        /** was cancel() called on this token or a copy of it? */
+        bool cancelled() const noexcept {
+            return cancelled_->load(std::memory_order_relaxed);
+        }
+
+        /** the flag for ParseOptions::cancelled, valid as long as a copy of the token is */
+        const std::atomic<bool>* flag() const noexcept {
+            return cancelled_.get();
+        }
+
+    private:
+        std::shared_ptr<std::atomic<bool>> cancelled_;
+    };
+
+    namespace detail {
+
+        /**
+         * What a parse_async() task needs, kept alive by the task.
+         */
+        class AsyncParse {
+        public:
+            std::string linkHeaderField;
+            std::string baseUri;
+            CancellationToken token;
+            ParseOptions options;
+            std::promise<ParseResult> promise;
+        };
+
+    }
+
+    /**
+     * Parses a Link header field like tryParse() on executor, e.g. the
+     * worker threads of an event loop, without waiting for it.
+     *
+     * @param linkHeaderField string containing the value of a Link header
+     *        field, moved or copied into the task
+     * @param baseUri the URI to resolve relative references against
+     * @param executor called once with a std::function<void()> that parses
+     *        the header field, which it must call once, on any thread
+     * @param token cancels the parse: if it is cancelled before the task
+     *        runs the task returns at once, and a running task stops before
+     *        its next link-value, both with ParseError::Cancelled and the
+     *        links parsed until then
+     * @param options the options, see ParseOptions; options.cancelled is
+     *        replaced by token
+     *
+     * @return the result, once the task ran; if executor destroys the task
+     *         without running it, the future holds std::future_error
+     */
+    template<typename Executor>
+    inline std::future<ParseResult> parse_async(std::string linkHeaderField, std::string baseUri,
+                                                Executor &&executor, CancellationToken token = CancellationToken(),
+                                                const ParseOptions &options = ParseOptions()) {
+        auto task = std::make_shared<detail::AsyncParse>();
+        task->linkHeaderField = std::move(linkHeaderField);
+        task->baseUri = std::move(baseUri);
+        task->token = std::move(token);
+        task->options = options;
+        task->options.cancelled = task->token.flag();
+        std::future<ParseResult> result = task->promise.get_future();
+
+        executor(std::function<void()>([task] {
+            ParseResult parsed;
+            detail::tryParseInto(task->linkHeaderField, task->baseUri, task->options, parsed);
+            task->promise.set_value(std::move(parsed));
+        }));
+        return result;
+    }
+
+    namespace detail {
+
+        /** the size of a cache line, to keep values that different threads write apart */
+        constexpr std::size_t cacheLineSize = 64;
+
+        /**
+         * A value with a cache line of padding on either side, so that
+         * writing it does not slow down threads that use its neighbours.
+         */
+        template<typename T>
+        class CacheLinePadded {
+        public:
+            CacheLinePadded() : value() {}
+
+            char before[cacheLineSize];
+            T value;
+            char after[cacheLineSize];
+        };
+
+        /**
+         * Waits for another thread: spins first, then yields, then sleeps.
+         */
+        class Backoff {
+        public:
+            Backoff() : rounds_(0) {}
+
+            void wait() {
+                if(rounds_ >= 128)
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                else if(rounds_ >= 64)
+                    std::this_thread::yield();
+                ++rounds_;
+            }
+
+            /** @return was this not the first wait since the last reset()? */
+            bool waiting() const {
+                return rounds_ != 0;
+            }
+
+            void reset() {
+                rounds_ = 0;
+            }
+
+        private:
+            unsigned rounds_;
+        };
+
+    }
+
+    /**
+     * A bounded lock-free queue for any number of producer and consumer
+     * threads, after Dmitry Vyukov's bounded MPMC queue: each slot has a
+     * sequence number that tells producers and consumers whose turn it is,
+     * so they only contend on the position they claim.
+     *
+     * @tparam T the type of the values, which must be default constructible
+     */
+    template<typename T>
+    class BoundedQueue {
+    public:
+        /**
+         * @param capacity the number of values the queue holds at most,
+         *        rounded up to a power of two
+         */
+        explicit BoundedQueue(std::size_t capacity)
+                : mask_(roundUp(capacity) - 1), cells_(new Cell[mask_ + 1]), enqueue_(), dequeue_() {
+            for(std::size_t i = 0; i <= mask_; ++i)
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        std::size_t capacity() const noexcept {
+            return mask_ + 1;
+        }
+
+        /** @return false if the queue is full */
+        bool tryPush(T value) {
+            std::size_t position = enqueue_.value.load(std::memory_order_relaxed);
+            Cell *cell;
+            for(;;) {
+                cell = &cells_[position & mask_];
+                std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                auto turn = static_cast<std::ptrdiff_t>(sequence - position);
+                if(turn == 0) {
+                    if(enqueue_.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if(turn < 0)
+                    return false;
+                else
+                    position = enqueue_.value.load(std::memory_order_relaxed);
+            }
+            cell->value = std::move(value);
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        /** @return false if the queue is empty */
+        bool tryPop(T &value) {
+            std::size_t position = dequeue_.value.load(std::memory_order_relaxed);
+            Cell *cell;
+            for(;;) {
+                cell = &cells_[position & mask_];
+                std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                auto turn = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+                if(turn == 0) {
+                    if(dequeue_.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if(turn < 0)
+                    return false;
+                else
+                    position = dequeue_.value.load(std::memory_order_relaxed);
+            }
+            value = std::move(cell->value);
+            cell->sequence.store(position + mask_ + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        class Cell {
+        public:
+            Cell() : sequence(0), value() {}
+
+            std::atomic<std::size_t> sequence;
+            T value;
+        };
+
+        static std::size_t roundUp(std::size_t capacity) {
+            std::size_t size = 1;
+            while(size < capacity)
+                size *= 2;
+            return size;
+        }
+
+        const std::size_t mask_;
+        std::unique_ptr<Cell[]> cells_;
+        detail::CacheLinePadded<std::atomic<std::size_t>> enqueue_;
+        detail::CacheLinePadded<std::atomic<std::size_t>> dequeue_;
+    };
+
+    /**
+     * A line of input to a Pipeline, and the result of parsing it.
+     */
+    class PipelineRecord {
+    public:
+        PipelineRecord() : sequence(0), line(), baseUri(), header(), result() {}
+
+        /** the number of the line in the input, from 0 */
+        std::uint64_t sequence;
+
+        /** the line, without its line break */
+        std::string line;
+
+        /** the base URI and the Link header field value in line */
+        StringView baseUri;
+        StringView header;
+
+        ParseResult result;
+    };
+
+    /**
+     * The work done by one stage of a Pipeline.
+     */
+    class PipelineStageStats {
+    public:
+        /** the lines the stage handled */
+        std::uint64_t items;
+
+        /**
+         * how often the stage had to wait: the reader for a line to be done
+         * with, because the later stages are behind (backpressure), and the
+         * later stages for their input
+         */
+        std::uint64_t stalls;
+    };
+
+    /**
+     * Counts of what a Pipeline did in its last run().
+     */
+    class PipelineStats {
+    public:
+        PipelineStageStats read;
+        PipelineStageStats parse;
+        PipelineStageStats sink;
+
+        /** the bytes of the lines read */
+        std::uint64_t bytes;
+
+        /** the time since run() started, or that it took */
+        double seconds;
+    };
+
+    /**
+     * Options of a Pipeline.
+     */
+    class PipelineOptions {
+    public:
+        PipelineOptions() noexcept : workers(0), capacity(1024), ordered(true), parse() {}
+
+        /** the number of threads that parse; 0 means one per hardware thread */
+        unsigned workers;
+
+        /** the number of lines that are read but not yet passed to the sink, at most */
+        std::size_t capacity;
+
+        /** pass the results to the sink in the order of the input, or as soon as they are parsed */
+        bool ordered;
+
+        /** the options of parsing each line */
+        ParseOptions parse;
+    };
+
+    /**
+     * Parses a stream of Link header fields in three stages connected by
+     * BoundedQueues: a thread that reads lines, worker threads that parse
+     * them, each with a ParseContext of its own, and the calling thread that
+     * passes the results to a sink.
+     *
+     * A fixed set of PipelineRecords circulates through the stages, so
+     * their storage is reused and the reader waits when the sink falls
+     * behind. Each line is a Link header field value, optionally preceded by
+     * the base URI to resolve it against and a tab.
+     */
+    class Pipeline {
+    public:
+        explicit Pipeline(const PipelineOptions &options = PipelineOptions())
+                : options_(options), records_(), free_(std::max<std::size_t>(1, options.capacity)),
+                  parse_(std::max<std::size_t>(1, options.capacity)), sink_(std::max<std::size_t>(1, options.capacity)),
+                  stop_(), readDone_(), readCount_(0), failure_(), start_(Clock::time_point()),
+                  end_(Clock::time_point()), counters_() {
+            options_.capacity = std::max<std::size_t>(1, options.capacity);
+            if(options_.workers == 0)
+                options_.workers = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        Pipeline(const Pipeline&) = delete;
+        Pipeline& operator=(const Pipeline&) = delete;
+
+        /**
+         * Parses each line of input and calls sink(PipelineRecord&) for it,
+         * on the calling thread, and returns once all lines are done. The
+         * record is reused once sink returns.
+         *
+         * If sink throws, the pipeline stops and run() throws the same.
+         */
+        template<typename Sink>
+        void run(std::istream &input, Sink &&sink) {
+            reset();
+            std::thread reader([this, &input] { read(input); });
+            std::vector<std::thread> workers;
+            for(unsigned i = 0; i < options_.workers; ++i)
+                workers.emplace_back([this] { parseRecords(); });
+
+#ifdef HLH_EXCEPTIONS
+            try {
+#endif
+                drain(sink);
+#ifdef HLH_EXCEPTIONS
+            } catch(...) {
+                stop_.value.store(true);
+                join(reader, workers);
+                throw;
+            }
+#endif
+            join(reader, workers);
+#ifdef HLH_EXCEPTIONS
+            if(failure_)
+                std::rethrow_exception(failure_);
+#endif
+        }
+
+        /** what the pipeline did in its last run, also while it runs */
+        PipelineStats stats() const {
+            bool done = end_.load() != Clock::time_point();
+            std::chrono::duration<double> seconds = (done ? end_.load() : Clock::now()) - start_.load();
+            return PipelineStats{{count(Read), count(ReadStalls)},
+                                 {count(Parsed), count(ParseStalls)},
+                                 {count(Sunk), count(SinkStalls)},
+                                 count(Bytes), seconds.count()};
+        }
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        enum Counter { Read, ReadStalls, Parsed, ParseStalls, Sunk, SinkStalls, Bytes, Counters };
+
+        std::uint64_t count(Counter counter) const {
+            return counters_[counter].value.load(std::memory_order_relaxed);
+        }
+
+        void add(Counter counter, std::uint64_t n = 1) {
+            counters_[counter].value.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        /** puts every record back into the free queue, wherever the last run left it */
+        void reset() {
+            PipelineRecord *record;
+            while(free_.tryPop(record) || parse_.tryPop(record) || sink_.tryPop(record)) {
+            }
+            for(auto &owned : records_)
+                free_.tryPush(owned.get());
+            for(auto &counter : counters_)
+                counter.value.store(0);
+            stop_.value.store(false);
+            readDone_.value.store(false);
+            readCount_ = 0;
+            failure_ = std::exception_ptr();
+            start_.store(Clock::now());
+            end_.store(Clock::time_point());
+        }
+
+        void join(std::thread &reader, std::vector<std::thread> &workers) {
+            reader.join();
+            for(auto &worker : workers)
+                worker.join();
+            end_.store(Clock::now());
+        }
+
+        /** splits record.line into its base URI and header field */
+        static void split(PipelineRecord &record) {
+            std::string &line = record.line;
+            if(!line.empty() && line.back() == '\r')
+                line.pop_back();
+            StringView all(line);
+            record.baseUri = StringView();
+            record.header = all;
+            // a base URI has no "<" and no spaces
+            std::size_t tab = line.find('\t');
+            if(tab != 0 && tab != std::string::npos && line.find_first_of("< ") > tab) {
+                record.baseUri = StringView(line.data(), tab);
+                record.header = StringView(line.data() + tab + 1, line.size() - tab - 1);
+            }
+        }
+
+        /** the reader stage */
+        void read(std::istream &input) {
+            std::uint64_t sequence = 0;
+#ifdef HLH_EXCEPTIONS
+            try {
+#endif
+                detail::Backoff backoff;
+                while(!stop_.value.load(std::memory_order_relaxed)) {
+                    PipelineRecord *record;
+                    if(!free_.tryPop(record)) {
+                        if(records_.size() < options_.capacity) {
+                            records_.emplace_back(new PipelineRecord());
+                            record = records_.back().get();
+                        }
+                        else {
+                            if(!backoff.waiting())
+                                add(ReadStalls);
+                            backoff.wait();
+                            continue;
+                        }
+                    }
+                    backoff.reset();
+
+                    if(!std::getline(input, record->line)) {
+                        free_.tryPush(record);
+                        break;
+                    }
+                    add(Bytes, record->line.size() + 1);
+                    split(*record);
+                    record->sequence = sequence++;
+                    // there is room for every record in each queue
+                    parse_.tryPush(record);
+                    add(Read);
+                }
+#ifdef HLH_EXCEPTIONS
+            } catch(...) {
+                failure_ = std::current_exception();
+            }
+#endif
+            readCount_ = sequence;
+            readDone_.value.store(true, std::memory_order_release);
+        }
+
+        /** a worker of the parse stage */
+        void parseRecords() {
+            ParseContext context;
+            detail::Backoff backoff;
+            for(;;) {
+                PipelineRecord *record;
+                if(!parse_.tryPop(record)) {
+                    if(stop_.value.load(std::memory_order_relaxed))
+                        return;
+                    // whatever the reader pushed is visible once it is done
+                    if(readDone_.value.load(std::memory_order_acquire)) {
+                        if(!parse_.tryPop(record))
+                            return;
+                    }
+                    else {
+                        if(!backoff.waiting())
+                            add(ParseStalls);
+                        backoff.wait();
+                        continue;
+                    }
+                }
+                backoff.reset();
+
+                context.parse(record->header, record->baseUri, options_.parse, record->result);
+                sink_.tryPush(record);
+                add(Parsed);
+            }
+        }
+
+        /** the sink stage */
+        template<typename Sink>
+        void drain(Sink &sink) {
+            // records waiting for their turn, at their sequence modulo the
+            // capacity: no more than that many are read but not yet sunk
+            std::vector<PipelineRecord*> pending(options_.ordered ? options_.capacity : 0, nullptr);
+            std::uint64_t next = 0;
+            std::uint64_t sunk = 0;
+
+            detail::Backoff backoff;
+            for(;;) {
+                PipelineRecord *record;
+                if(!sink_.tryPop(record)) {
+                    if(stop_.value.load(std::memory_order_relaxed))
+                        return;
+                    if(readDone_.value.load(std::memory_order_acquire) && sunk == readCount_)
+                        return;
+                    if(!backoff.waiting())
+                        add(SinkStalls);
+                    backoff.wait();
+                    continue;
+                }
+                backoff.reset();
+
+                if(!options_.ordered) {
+                    sinkRecord(sink, *record);
+                    ++sunk;
+                    continue;
+                }
+                pending[record->sequence % pending.size()] = record;
+                while((record = pending[next % pending.size()]) != nullptr) {
+                    pending[next % pending.size()] = nullptr;
+                    sinkRecord(sink, *record);
+                    ++next;
+                    ++sunk;
+                }
+            }
+        }
+
+        template<typename Sink>
+        void sinkRecord(Sink &sink, PipelineRecord &record) {
+            sink(record);
+            free_.tryPush(&record);
+            add(Sunk);
+        }
+
+        PipelineOptions options_;
+
+        // only the reader adds records, and only run() uses them otherwise
+        std::vector<std::unique_ptr<PipelineRecord>> records_;
+
+        // the records that are free to read into, parse and sink
+        BoundedQueue<PipelineRecord*> free_;
+        BoundedQueue<PipelineRecord*> parse_;
+        BoundedQueue<PipelineRecord*> sink_;
+
+        detail::CacheLinePadded<std::atomic<bool>> stop_;
+        detail::CacheLinePadded<std::atomic<bool>> readDone_;
+        // written by the reader before readDone_
+        std::uint64_t readCount_;
+        std::exception_ptr failure_;
+
+        std::atomic<Clock::time_point> start_;
+        std::atomic<Clock::time_point> end_;
+        detail::CacheLinePadded<std::atomic<std::uint64_t>> counters_[Counters];
+    };
+
+}
+
+#endif //HTTP_LINK_HEADER_PARALLEL_H
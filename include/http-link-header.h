@@ -3,17 +3,800 @@
 
 #include <uriparser/Uri.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <set>
 #include <vector>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
 #include <sstream>
 #include <iostream>
 #include <memory>
+#include <utility>
 #include <algorithm>
+#include <iterator>
+#include <atomic>
+#include <chrono>
+
+/**
+ * The maximum number of extension relation types that relationId() interns.
+ * Extension relation types seen after the table is full get an uninterned
+ * identifier instead, see isInterned(), so hostile headers cannot grow it
+ * without bound.
+ */
+#ifndef HLH_RELATION_INTERN_LIMIT
+#define HLH_RELATION_INTERN_LIMIT 4096
+#endif
+
+/**
+ * Defined when exceptions are enabled. Without them (-fno-exceptions) the
+ * try* functions cannot report ParseError::OutOfMemory, and failing
+ * allocations terminate the program instead.
+ */
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define HLH_EXCEPTIONS 1
+#endif
+
+/**
+ * Define HLH_ENABLE_STATS to count what parse() and parseGroups() do, see
+ * http_link_header::stats(). Without it the counting compiles to nothing.
+ */
+#ifdef HLH_ENABLE_STATS
+#define HLH_STATS_ADD(counter, n) \
+    ::http_link_header::detail::threadStats().add(::http_link_header::detail::StatsCounter::counter, (n))
+#define HLH_STATS_TIMER(counter) \
+    ::http_link_header::detail::StatsTimer hlh_stats_timer_(::http_link_header::detail::StatsCounter::counter)
+#else
+#define HLH_STATS_ADD(counter, n) ((void)0)
+#define HLH_STATS_TIMER(counter) ((void)0)
+#endif
+
+/**
+ * Define HLH_ENABLE_TRACING to have parse() and parseGroups() call the hook
+ * set with http_link_header::setTraceHook() at the beginning and end of each
+ * phase of parsing a link-value. Define HLH_ENABLE_USDT on Linux to fire the
+ * USDT probes http_link_header:phase__begin and http_link_header:phase__end
+ * (from <sys/sdt.h>) there, with the TracePhase as their argument. Without
+ * either the tracing compiles to nothing.
+ */
+#ifdef HLH_ENABLE_USDT
+#include <sys/sdt.h>
+#endif
+
+#if defined(HLH_ENABLE_TRACING) || defined(HLH_ENABLE_USDT)
+#define HLH_TRACE_BEGIN(phase) ::http_link_header::detail::trace(::http_link_header::TracePhase::phase, true)
+#define HLH_TRACE_END(phase) ::http_link_header::detail::trace(::http_link_header::TracePhase::phase, false)
+#else
+#define HLH_TRACE_BEGIN(phase) ((void)0)
+#define HLH_TRACE_END(phase) ((void)0)
+#endif
 
 
 namespace http_link_header {
 
+    /**
+     * A non-owning reference to a range of characters.
+     *
+     * Used by the allocation-free APIs (like extract_pagination()) to point
+     * back into the caller's header string, so the referenced buffer must
+     * outlive the StringView.
+     */
+    class StringView {
+    public:
+        StringView() : data_(nullptr), size_(0) {}
+
+        StringView(const char *data, std::size_t size) : data_(data), size_(size) {}
+
+        StringView(const char *str) : data_(str), size_(str ? std::strlen(str) : 0) {} // NOLINT(google-explicit-constructor)
+
+        StringView(const std::string &str) : data_(str.data()), size_(str.size()) {} // NOLINT(google-explicit-constructor)
+
+        const char* data() const { return data_; }
+        std::size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+
+        const char* begin() const { return data_; }
+        const char* end() const { return data_ + size_; }
+
+        char operator[](std::size_t i) const { return data_[i]; }
+
+        std::string str() const {
+            return data_ ? std::string(data_, size_) : std::string();
+        }
+
+        bool operator==(const StringView &rhs) const {
+            return size_ == rhs.size_ &&
+                   (size_ == 0 || std::memcmp(data_, rhs.data_, size_) == 0);
+        }
+
+        bool operator!=(const StringView &rhs) const {
+            return !(rhs == *this);
+        }
+
+    private:
+        const char *data_;
+        std::size_t size_;
+    };
+
+    namespace detail {
+
+        inline bool isWhitespace(char c) {
+            return c == ' ' || c == '\t';
+        }
+
+        constexpr char toLower(char c) {
+            return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+
+        inline const char* skipWhitespace(const char *p, const char *end) {
+            while(p != end && isWhitespace(*p))
+                ++p;
+            return p;
+        }
+
+        /**
+         * Does str equal the lowercase literal, ignoring ASCII case?
+         */
+        inline bool equalsLowercase(StringView str, const char *literal) {
+            for(char c : str) {
+                if(*literal++ != toLower(c))
+                    return false;
+            }
+            return *literal == '\0';
+        }
+
+    }
+
+    /**
+     * Numeric identifier of a link relation type.
+     *
+     * Values up to Relation::Extension are the members of Relation; larger
+     * values identify extension relation types interned by relationId(),
+     * except uninterned ones, see isInterned().
+     */
+    typedef std::uint32_t RelationId;
+
+    namespace detail {
+
+        /** the bit that marks an uninterned RelationId */
+        constexpr RelationId uninternedRelationBit = 0x80000000u;
+
+    }
+
+    /**
+     * Does id identify its relation type? Once the table of interned
+     * extension relation types is full (see HLH_RELATION_INTERN_LIMIT),
+     * relationId() gives each further extension relation type a new
+     * uninterned identifier on every call, which is equal to no other
+     * identifier, not even one for the same relation type. Compare the
+     * names of such relation types instead, e.g. with Link::sameRelation().
+     */
+    constexpr bool isInterned(RelationId id) {
+        return (id & detail::uninternedRelationBit) == 0;
+    }
+
+    /**
+     * The link relation types registered with IANA, see
+     * https://www.iana.org/assignments/link-relations/
+     */
+    enum class Relation : RelationId {
+        /** no relation type, or a link that was not produced by parse() */
+        None = 0,
+        About,
+        Acl,
+        Alternate,
+        Amphtml,
+        Appendix,
+        AppleTouchIcon,
+        AppleTouchStartupImage,
+        Archives,
+        Author,
+        BlockedBy,
+        Bookmark,
+        Canonical,
+        Chapter,
+        CiteAs,
+        Collection,
+        Contents,
+        Convertedfrom,
+        Copyright,
+        CreateForm,
+        Current,
+        Describedby,
+        Describes,
+        Disclosure,
+        DnsPrefetch,
+        Duplicate,
+        Edit,
+        EditForm,
+        EditMedia,
+        Enclosure,
+        External,
+        First,
+        Glossary,
+        Help,
+        Hosts,
+        Hub,
+        Icon,
+        Index,
+        Intervalafter,
+        Intervalbefore,
+        Intervalcontains,
+        Intervaldisjoint,
+        Intervalduring,
+        Intervalequals,
+        Intervalfinishedby,
+        Intervalfinishes,
+        Intervalin,
+        Intervalmeets,
+        Intervalmetby,
+        Intervaloverlappedby,
+        Intervaloverlaps,
+        Intervalstartedby,
+        Intervalstarts,
+        Item,
+        Last,
+        LatestVersion,
+        License,
+        Linkset,
+        Lrdd,
+        Manifest,
+        MaskIcon,
+        Me,
+        MediaFeed,
+        Memento,
+        Micropub,
+        Modulepreload,
+        Monitor,
+        MonitorGroup,
+        Next,
+        NextArchive,
+        Nofollow,
+        Noopener,
+        Noreferrer,
+        Opener,
+        Openid2LocalId,
+        Openid2Provider,
+        Original,
+        P3pv1,
+        Payment,
+        Pingback,
+        Preconnect,
+        PredecessorVersion,
+        Prefetch,
+        Preload,
+        Prerender,
+        Prev,
+        PrevArchive,
+        Preview,
+        Previous,
+        PrivacyPolicy,
+        Profile,
+        Publication,
+        Related,
+        Replies,
+        Restconf,
+        Ruleinput,
+        Search,
+        Section,
+        Self,
+        Service,
+        ServiceDesc,
+        ServiceDoc,
+        ServiceMeta,
+        SipTrunkingRate,
+        Sponsored,
+        Start,
+        Status,
+        Stylesheet,
+        Subsection,
+        SuccessorVersion,
+        Sunset,
+        Tag,
+        TermsOfService,
+        Timegate,
+        Timemap,
+        Type,
+        Ugc,
+        Up,
+        VersionHistory,
+        Via,
+        Webmention,
+        WorkingCopy,
+        WorkingCopyOf,
+        /** an extension relation type that was not interned */
+        Extension
+    };
+
+    namespace detail {
+
+        /**
+         * Case-insensitive FNV-1a hash of a relation type.
+         */
+        constexpr std::uint32_t relationHash(const char *p, std::size_t n, std::uint32_t h = 2166136261u) {
+            return n == 0 ? h : relationHash(p + 1, n - 1,
+                                             (h ^ static_cast<unsigned char>(toLower(*p))) * 16777619u);
+        }
+
+        /** the length of the longest registered relation type */
+        constexpr std::size_t maxRelationNameSize = 25;
+
+        inline const char* const* relationNames() {
+            static const char* const names[] = {
+                "",
+                "about", "acl", "alternate", "amphtml", "appendix", "apple-touch-icon",
+                "apple-touch-startup-image", "archives", "author", "blocked-by", "bookmark",
+                "canonical", "chapter", "cite-as", "collection", "contents", "convertedfrom",
+                "copyright", "create-form", "current", "describedby", "describes", "disclosure",
+                "dns-prefetch", "duplicate", "edit", "edit-form", "edit-media", "enclosure",
+                "external", "first", "glossary", "help", "hosts", "hub", "icon", "index",
+                "intervalafter", "intervalbefore", "intervalcontains", "intervaldisjoint",
+                "intervalduring", "intervalequals", "intervalfinishedby", "intervalfinishes",
+                "intervalin", "intervalmeets", "intervalmetby", "intervaloverlappedby",
+                "intervaloverlaps", "intervalstartedby", "intervalstarts", "item", "last",
+                "latest-version", "license", "linkset", "lrdd", "manifest", "mask-icon", "me",
+                "media-feed", "memento", "micropub", "modulepreload", "monitor", "monitor-group",
+                "next", "next-archive", "nofollow", "noopener", "noreferrer", "opener",
+                "openid2.local_id", "openid2.provider", "original", "p3pv1", "payment", "pingback",
+                "preconnect", "predecessor-version", "prefetch", "preload", "prerender", "prev",
+                "prev-archive", "preview", "previous", "privacy-policy", "profile", "publication",
+                "related", "replies", "restconf", "ruleinput", "search", "section", "self",
+                "service", "service-desc", "service-doc", "service-meta", "sip-trunking-rate",
+                "sponsored", "start", "status", "stylesheet", "subsection", "successor-version",
+                "sunset", "tag", "terms-of-service", "timegate", "timemap", "type", "ugc", "up",
+                "version-history", "via", "webmention", "working-copy", "working-copy-of",
+                ""
+            };
+            return names;
+        }
+
+        /** the number of buckets of relation hashes, see relationSlot() */
+        constexpr std::uint32_t relationBuckets = 32;
+
+        /** the number of slots of relationSlots() */
+        constexpr std::uint32_t relationSlotCount = 128;
+
+        /**
+         * The displacement of each bucket of relation hashes, generated by
+         * test/relation_tables.cpp from relationNames().
+         */
+        inline const std::uint16_t* relationDisplacements() {
+            static const std::uint16_t displacements[relationBuckets] = {
+                  1, 127,   2,   4,   1,  27,   3,   9, 118, 104,   2, 120,   1,   2,  32,   1,
+                 17,   1,   3,  15, 224,  41,  48, 105,  61,   1, 164,  85,  11,  49, 279,  42
+            };
+            return displacements;
+        }
+
+        /**
+         * Mixes a relation hash with a displacement into a slot of
+         * relationSlots().
+         */
+        inline std::uint32_t relationSlot(std::uint32_t hash, std::uint32_t displacement) {
+            std::uint32_t x = (hash ^ displacement) * 0x9E3779B1u;
+            return (x ^ (x >> 16)) & (relationSlotCount - 1);
+        }
+
+        /**
+         * Maps a relation hash to its slot in relationSlots().
+         *
+         * Together with relationSlots() this is a minimal perfect hash
+         * ("hash and displace") over the registered relation types, so
+         * classifying a token costs one hash and one comparison.
+         */
+        inline std::uint32_t relationSlot(std::uint32_t hash) {
+            return relationSlot(hash, relationDisplacements()[hash & (relationBuckets - 1)]);
+        }
+
+        /**
+         * The Relation of each slot, 0 for none, generated by
+         * test/relation_tables.cpp from relationNames().
+         */
+        inline const std::uint8_t* relationSlots() {
+            static const std::uint8_t slots[relationSlotCount] = {
+                 15,  51,   6,  32, 103,  33,   4,  78,  13, 114,  25,  81,  79,  19,  39,  77,
+                 21,  60,  10,  31, 101,  41,  14,  82, 109,  20,  37,  43,  66, 112,  42,   8,
+                  5,  30,  29,  91,   0,  56,  11,  68,  44,  28,  95,  23,  74,  24,  72,   1,
+                100, 119,  71,  90,  40, 122, 102,  61,   0,  73, 115,  26,  35,  69,  27,   7,
+                 50,  84,   0,  53,  70,  75,  65,   3,  16, 121,  85,  89,  99, 116, 111,  48,
+                 97,  94,  47,  98,  62,  57,  34,  18,  49,   9,  67,  88, 105,  58,  52, 118,
+                 17,  87, 107,  45,   0, 117, 113,  46,  96,  54,  80,  76,  36,  86,  38,   2,
+                 22, 106,  12, 104,   0,  63,  64, 110,   0,  59,  92,  83, 120,  55,  93, 108
+            };
+            return slots;
+        }
+
+        /**
+         * The table of interned extension relation types.
+         */
+        class RelationTable {
+        public:
+            RelationId intern(const std::string &lowercaseName) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto found = ids_.find(lowercaseName);
+                if(found != ids_.end())
+                    return found->second;
+                if(names_.size() >= HLH_RELATION_INTERN_LIMIT)
+                    return uninterned_++ | uninternedRelationBit;
+                auto id = static_cast<RelationId>(Relation::Extension) + 1 +
+                          static_cast<RelationId>(names_.size());
+                names_.push_back(lowercaseName);
+                ids_.emplace(lowercaseName, id);
+                return id;
+            }
+
+            StringView name(RelationId id) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                std::size_t index = id - static_cast<RelationId>(Relation::Extension) - 1;
+                if(index >= names_.size())
+                    return StringView();
+                // deque never moves its elements when growing at the end
+                return names_[index];
+            }
+
+        private:
+            std::mutex mutex_;
+            std::unordered_map<std::string, RelationId> ids_;
+            std::deque<std::string> names_;
+            // the uninterned identifiers handed out, which wrap after 2^31
+            RelationId uninterned_ = 0;
+        };
+
+        inline RelationTable& relationTable() {
+            static RelationTable table;
+            return table;
+        }
+
+    }
+
+    /**
+     * Classifies a relation type as one of the registered relation types,
+     * ignoring case and without allocating.
+     *
+     * @param relationType the relation type to classify
+     * @return the registered relation type, or Relation::Extension if it is not registered
+     */
+    inline Relation registeredRelation(StringView relationType) {
+        if(relationType.empty())
+            return Relation::None;
+        if(relationType.size() > detail::maxRelationNameSize)
+            return Relation::Extension;
+
+        std::uint8_t candidate = detail::relationSlots()[
+                detail::relationSlot(detail::relationHash(relationType.data(), relationType.size()))];
+        if(candidate == 0)
+            return Relation::Extension;
+
+        const char *name = detail::relationNames()[candidate];
+        for(char c : relationType) {
+            if(*name++ != detail::toLower(c))
+                return Relation::Extension;
+        }
+        if(*name != '\0')
+            return Relation::Extension;
+        return static_cast<Relation>(candidate);
+    }
+
+    /**
+     * Returns the identifier of a relation type: its Relation if it is
+     * registered, otherwise an identifier from the global table of interned
+     * extension relation types. Relation types that only differ in case get
+     * the same identifier, except once the table is full, see isInterned().
+     *
+     * This is safe to call from multiple threads. Identifiers never change
+     * once assigned, so each thread remembers the extension relation types it
+     * has seen and only locks the global table for new ones.
+     *
+     * @param relationType the relation type
+     * @return the identifier of relationType
+     */
+    inline RelationId relationId(StringView relationType) {
+        Relation relation = registeredRelation(relationType);
+        if(relation != Relation::Extension)
+            return static_cast<RelationId>(relation);
+
+        std::string lowercaseName;
+        lowercaseName.reserve(relationType.size());
+        for(char c : relationType)
+            lowercaseName.push_back(detail::toLower(c));
+
+        thread_local std::unordered_map<std::string, RelationId> seen;
+        auto found = seen.find(lowercaseName);
+        if(found != seen.end())
+            return found->second;
+
+        RelationId id = detail::relationTable().intern(lowercaseName);
+        if(isInterned(id))
+            seen.emplace(std::move(lowercaseName), id);
+        return id;
+    }
+
+    /**
+     * Returns the lowercase name of a relation type identifier.
+     *
+     * @param id an identifier returned by relationId()
+     * @return the name, or an empty view if id is unknown or uninterned
+     */
+    inline StringView relationName(RelationId id) {
+        if(id < static_cast<RelationId>(Relation::Extension))
+            return detail::relationNames()[id];
+        if(!isInterned(id))
+            return StringView();
+        return detail::relationTable().name(id);
+    }
+
+    /**
+     * Counts of what parse() and parseGroups() did, summed over all threads.
+     * The counters only ever grow; take the difference of two snapshots to
+     * look at an interval.
+     */
+    class Stats {
+    public:
+        /** Link header field values parsed */
+        std::uint64_t headers;
+
+        /** bytes of field values consumed */
+        std::uint64_t bytes;
+
+        /** links emitted, one per relation type of each link-value */
+        std::uint64_t links;
+
+        /** link parameters seen, before steps 9 to 16 drop any */
+        std::uint64_t parameters;
+
+        /** star parameters (such as title*) seen */
+        std::uint64_t starParameters;
+
+        /** target and context URI resolutions attempted, and those that failed */
+        std::uint64_t resolutions;
+        std::uint64_t failedResolutions;
+
+        /** field values whose parsing stopped at a malformed link-value */
+        std::uint64_t earlyExits;
+
+        /** time spent resolving URIs and tokenizing link-values (steps 1 to 7) */
+        std::uint64_t resolveNanoseconds;
+        std::uint64_t tokenizeNanoseconds;
+
+        /** were the counters compiled in (HLH_ENABLE_STATS)? */
+        static bool enabled() {
+#ifdef HLH_ENABLE_STATS
+            return true;
+#else
+            return false;
+#endif
+        }
+    };
+
+#ifdef HLH_ENABLE_STATS
+    namespace detail {
+
+        namespace StatsCounter {
+            enum Counter {
+                Headers, Bytes, Links, Parameters, StarParameters, Resolutions, FailedResolutions, EarlyExits,
+                ResolveNanoseconds, TokenizeNanoseconds, Count
+            };
+        }
+
+        inline void addTo(Stats &stats, const std::uint64_t (&counters)[StatsCounter::Count]) {
+            stats.headers += counters[StatsCounter::Headers];
+            stats.bytes += counters[StatsCounter::Bytes];
+            stats.links += counters[StatsCounter::Links];
+            stats.parameters += counters[StatsCounter::Parameters];
+            stats.starParameters += counters[StatsCounter::StarParameters];
+            stats.resolutions += counters[StatsCounter::Resolutions];
+            stats.failedResolutions += counters[StatsCounter::FailedResolutions];
+            stats.earlyExits += counters[StatsCounter::EarlyExits];
+            stats.resolveNanoseconds += counters[StatsCounter::ResolveNanoseconds];
+            stats.tokenizeNanoseconds += counters[StatsCounter::TokenizeNanoseconds];
+        }
+
+        class ThreadStats;
+
+        /**
+         * The counters of all live threads, and the sums of those of threads
+         * that have exited.
+         */
+        class StatsRegistry {
+        public:
+            StatsRegistry() : retired_() {}
+
+            void attach(ThreadStats *stats) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                live_.push_back(stats);
+            }
+
+            void detach(ThreadStats *stats, const std::uint64_t (&counters)[StatsCounter::Count]) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for(int i = 0; i < StatsCounter::Count; ++i)
+                    retired_[i] += counters[i];
+                live_.erase(std::remove(live_.begin(), live_.end(), stats), live_.end());
+            }
+
+            Stats sum();
+
+        private:
+            std::mutex mutex_;
+            std::vector<ThreadStats*> live_;
+            std::uint64_t retired_[StatsCounter::Count];
+        };
+
+        inline StatsRegistry& statsRegistry() {
+            static StatsRegistry registry;
+            return registry;
+        }
+
+        /**
+         * The counters of one thread. Only the owning thread writes them, so
+         * adding is a relaxed load and store rather than a locked
+         * read-modify-write; stats() reads them from other threads.
+         */
+        class ThreadStats {
+        public:
+            ThreadStats() {
+                for(auto &counter : counters_)
+                    counter.store(0, std::memory_order_relaxed);
+                statsRegistry().attach(this);
+            }
+
+            ~ThreadStats() {
+                std::uint64_t counters[StatsCounter::Count];
+                read(counters);
+                statsRegistry().detach(this, counters);
+            }
+
+            void add(StatsCounter::Counter counter, std::uint64_t n) {
+                counters_[counter].store(counters_[counter].load(std::memory_order_relaxed) + n,
+                                         std::memory_order_relaxed);
+            }
+
+            void read(std::uint64_t (&counters)[StatsCounter::Count]) const {
+                for(int i = 0; i < StatsCounter::Count; ++i)
+                    counters[i] = counters_[i].load(std::memory_order_relaxed);
+            }
+
+        private:
+            std::atomic<std::uint64_t> counters_[StatsCounter::Count];
+        };
+
+        inline Stats StatsRegistry::sum() {
+            Stats stats{};
+            std::lock_guard<std::mutex> lock(mutex_);
+            addTo(stats, retired_);
+            for(const ThreadStats *thread : live_) {
+                std::uint64_t counters[StatsCounter::Count];
+                thread->read(counters);
+                addTo(stats, counters);
+            }
+            return stats;
+        }
+
+        inline ThreadStats& threadStats() {
+            thread_local ThreadStats stats;
+            return stats;
+        }
+
+        /**
+         * Adds the time between its construction and destruction to a
+         * counter.
+         */
+        class StatsTimer {
+        public:
+            explicit StatsTimer(StatsCounter::Counter counter)
+                    : counter_(counter), start_(std::chrono::steady_clock::now()) {}
+
+            ~StatsTimer() {
+                auto elapsed = std::chrono::steady_clock::now() - start_;
+                threadStats().add(counter_, static_cast<std::uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+            }
+
+        private:
+            StatsCounter::Counter counter_;
+            std::chrono::steady_clock::time_point start_;
+        };
+
+    }
+#endif
+
+    /**
+     * Returns the parse statistics of all threads so far. All counters are
+     * zero unless HLH_ENABLE_STATS is defined.
+     */
+    inline Stats stats() {
+#ifdef HLH_ENABLE_STATS
+        return detail::statsRegistry().sum();
+#else
+        return Stats{};
+#endif
+    }
+
+    /**
+     * The phases of parsing a link-value, in the order they happen, as
+     * reported to the tracing hook and the USDT probes.
+     */
+    enum class TracePhase : std::uint8_t {
+        /** steps 1 to 7: finding the target and scanning the parameters (Appendix B.3) */
+        TokenizeLinkValue,
+        /** step 8: resolving the target (uri::resolve()) */
+        ResolveTarget,
+        /** steps 9 to 16: picking rel and anchor and building the target attributes */
+        ProcessParameters,
+        /** step 12: resolving the context (uri::resolve()) */
+        ResolveContext,
+        /** steps 10 and 17.1: splitting, case-normalising and identifying the relation types */
+        ExpandRelations,
+        /** step 17.2: creating a Link per relation type, for parse() only */
+        AppendLinks
+    };
+
+    /**
+     * A tracing hook, called with begin set at the start of a phase and with
+     * begin clear at its end.
+     */
+    typedef void (*TraceHook)(TracePhase phase, bool begin, void *context);
+
+    namespace detail {
+
+        class TraceHookSlot {
+        public:
+            TraceHookSlot() : hook(nullptr), context(nullptr) {}
+
+            std::atomic<TraceHook> hook;
+            std::atomic<void*> context;
+        };
+
+        inline TraceHookSlot& traceHookSlot() {
+            static TraceHookSlot slot;
+            return slot;
+        }
+
+#if defined(HLH_ENABLE_TRACING) || defined(HLH_ENABLE_USDT)
+        inline void trace(TracePhase phase, bool begin) {
+#ifdef HLH_ENABLE_TRACING
+            TraceHookSlot &slot = traceHookSlot();
+            if(TraceHook hook = slot.hook.load(std::memory_order_acquire))
+                hook(phase, begin, slot.context.load(std::memory_order_relaxed));
+#endif
+#ifdef HLH_ENABLE_USDT
+            if(begin) {
+                DTRACE_PROBE1(http_link_header, phase__begin, static_cast<int>(phase));
+            }
+            else {
+                DTRACE_PROBE1(http_link_header, phase__end, static_cast<int>(phase));
+            }
+#endif
+        }
+#endif
+
+    }
+
+    /**
+     * Sets the tracing hook that parse() and parseGroups() call from every
+     * thread, or removes it if hook is nullptr. Set it before parsing
+     * starts: a parse running concurrently may see the new hook with the
+     * old context.
+     *
+     * @param hook the hook
+     * @param context passed to every call of hook
+     * @return false if HLH_ENABLE_TRACING is not defined, in which case the
+     *         hook is never called
+     */
+    inline bool setTraceHook(TraceHook hook, void *context = nullptr) {
+        detail::TraceHookSlot &slot = detail::traceHookSlot();
+        slot.context.store(context, std::memory_order_relaxed);
+        slot.hook.store(hook, std::memory_order_release);
+#ifdef HLH_ENABLE_TRACING
+        return true;
+#else
+        return false;
+#endif
+    }
+
     namespace uri {
 
         class Uri {
@@ -85,34 +868,145 @@ namespace http_link_header {
                     base_uri.get_uri()) != URI_SUCCESS)
                 return false;
 
-            // convert uri to string and return
+            // convert uri to string, directly into result, and return
 
             int chars_required;
             if (uriToStringCharsRequiredA(result_uri.get_uri(),
                                           &chars_required) != URI_SUCCESS) {
                 return false;
             }
-            std::unique_ptr<char> dest_str(new char[chars_required+1]);
-            if (!dest_str) {
-                return false;
-            }
+            result->resize(static_cast<std::size_t>(chars_required) + 1);
             int chars_written;
-            if (uriToStringA(dest_str.get(), result_uri.get_uri(),
+            if (uriToStringA(&(*result)[0], result_uri.get_uri(),
                              chars_required+1, &chars_written) != URI_SUCCESS) {
+                result->clear();
                 return false;
             }
-            *result = dest_str.get();
+            result->resize(std::strlen(result->c_str()));
 
             return true;
         }
 
     }
 
+    /**
+     * The link parameters and target attributes known to this library.
+     */
+    enum class Param : std::uint8_t {
+        Unknown = 0,
+        Rel,
+        Anchor,
+        Rev,
+        Hreflang,
+        Media,
+        Title,
+        TitleStar,
+        Type,
+        As,
+        Crossorigin,
+        Integrity,
+        Nopush,
+        /** the number of members, not a parameter */
+        Count
+    };
+
+    static_assert(static_cast<unsigned>(Param::Count) <= 32, "Param ids are used as bits of a 32 bit mask");
+
+    /**
+     * Classifies a parameter name, ignoring case and without allocating.
+     *
+     * @param name the parameter name
+     * @return the known parameter, or Param::Unknown
+     */
+    inline Param knownParameter(StringView name) {
+        if(name.empty())
+            return Param::Unknown;
+
+        switch(name.size()) {
+            case 2:
+                if(detail::equalsLowercase(name, "as"))
+                    return Param::As;
+                break;
+            case 3:
+                if(detail::equalsLowercase(name, "rel"))
+                    return Param::Rel;
+                if(detail::equalsLowercase(name, "rev"))
+                    return Param::Rev;
+                break;
+            case 4:
+                if(detail::equalsLowercase(name, "type"))
+                    return Param::Type;
+                break;
+            case 5:
+                switch(detail::toLower(name[0])) {
+                    case 'm':
+                        if(detail::equalsLowercase(name, "media"))
+                            return Param::Media;
+                        break;
+                    case 't':
+                        if(detail::equalsLowercase(name, "title"))
+                            return Param::Title;
+                        break;
+                    default:
+                        break;
+                }
+                break;
+            case 6:
+                switch(detail::toLower(name[0])) {
+                    case 'a':
+                        if(detail::equalsLowercase(name, "anchor"))
+                            return Param::Anchor;
+                        break;
+                    case 'n':
+                        if(detail::equalsLowercase(name, "nopush"))
+                            return Param::Nopush;
+                        break;
+                    case 't':
+                        if(detail::equalsLowercase(name, "title*"))
+                            return Param::TitleStar;
+                        break;
+                    default:
+                        break;
+                }
+                break;
+            case 8:
+                if(detail::equalsLowercase(name, "hreflang"))
+                    return Param::Hreflang;
+                break;
+            case 9:
+                if(detail::equalsLowercase(name, "integrity"))
+                    return Param::Integrity;
+                break;
+            case 11:
+                if(detail::equalsLowercase(name, "crossorigin"))
+                    return Param::Crossorigin;
+                break;
+            default:
+                break;
+        }
+        return Param::Unknown;
+    }
+
     class TargetAttribute {
     public:
+        TargetAttribute() : id(Param::Unknown) {}
+
+        TargetAttribute(std::string attributeName, std::string attributeValue)
+                : name(std::move(attributeName)),
+                  value(std::move(attributeValue)),
+                  id(knownParameter(name)) {}
+
+        TargetAttribute(std::string attributeName, std::string attributeValue, Param attributeId)
+                : name(std::move(attributeName)),
+                  value(std::move(attributeValue)),
+                  id(attributeId) {}
+
         std::string name;
         std::string value;
 
+        /** the classification of name, see knownParameter() */
+        Param id;
+
         bool operator==(const TargetAttribute &rhs) const {
             return name == rhs.name &&
                    value == rhs.value;
@@ -123,344 +1017,470 @@ namespace http_link_header {
         }
     };
 
+    /**
+     * Maps each known parameter to the position of the first target attribute
+     * with that name, so looking one up is a single array access.
+     */
+    class AttributeIndex {
+    public:
+        AttributeIndex() {
+            clear();
+        }
+
+        explicit AttributeIndex(const std::vector<TargetAttribute> &attributes) {
+            build(attributes);
+        }
+
+        void clear() {
+            std::fill(positions_, positions_ + count_, static_cast<std::uint16_t>(none_));
+        }
+
+        void build(const std::vector<TargetAttribute> &attributes) {
+            clear();
+            for(std::size_t i = 0; i < attributes.size() && i < static_cast<std::size_t>(none_); ++i) {
+                auto slot = static_cast<std::size_t>(attributes[i].id);
+                if(slot != 0 && positions_[slot] == none_)
+                    positions_[slot] = static_cast<std::uint16_t>(i);
+            }
+        }
+
+        /**
+         * @return the position of the first attribute with id, or attributes.size()
+         */
+        std::size_t find(Param id, const std::vector<TargetAttribute> &attributes) const {
+            std::size_t position = positions_[static_cast<std::size_t>(id)];
+            if(position < attributes.size() && attributes[position].id == id)
+                return position;
+
+            // not indexed, or targetAttributes changed since the index was built
+            for(position = 0; position < attributes.size(); ++position) {
+                if(attributes[position].id == id)
+                    break;
+            }
+            return position;
+        }
+
+    private:
+        enum : std::uint16_t {
+            count_ = static_cast<std::uint16_t>(Param::Count),
+            none_ = 0xffff
+        };
+
+        std::uint16_t positions_[count_];
+    };
+
     class Link {
     public:
+        Link() : linkRelationId(0) {}
+
+        Link(std::string context, std::string relation, std::string target,
+             std::vector<TargetAttribute> attributes, RelationId relationId = 0)
+                : linkContext(std::move(context)),
+                  linkRelation(std::move(relation)),
+                  linkTarget(std::move(target)),
+                  targetAttributes(std::move(attributes)),
+                  linkRelationId(relationId),
+                  attributeIndex(targetAttributes) {}
+
         std::string linkContext;
         std::string linkRelation;
         std::string linkTarget;
         std::vector<TargetAttribute> targetAttributes;
 
-        bool operator==(const Link &rhs) const {
-            return linkContext == rhs.linkContext &&
-                   linkRelation == rhs.linkRelation &&
-                   linkTarget == rhs.linkTarget &&
-                   targetAttributes == rhs.targetAttributes;
+        /**
+         * the identifier of linkRelation, see relationId(); an uninterned
+         * one (see isInterned()) is equal to no other, so compare relation
+         * types with sameRelation()
+         */
+        RelationId linkRelationId;
+
+        /**
+         * Does this link have the given registered relation type?
+         */
+        bool hasRelation(Relation relation) const {
+            return linkRelationId == static_cast<RelationId>(relation);
         }
 
-        bool operator!=(const Link &rhs) const {
+        /**
+         * Does this link have the same relation type as other? Compares the
+         * identifiers, or the names if either is uninterned.
+         */
+        bool sameRelation(const Link &other) const {
+            if(isInterned(linkRelationId) && isInterned(other.linkRelationId))
+                return linkRelationId == other.linkRelationId;
+            return linkRelation == other.linkRelation;
+        }
+
+        /**
+         * Index of targetAttributes by known parameter. Call
+         * indexAttributes() after changing targetAttributes; until then
+         * attr() falls back to scanning.
+         */
+        AttributeIndex attributeIndex;
+
+        void indexAttributes() {
+            attributeIndex.build(targetAttributes);
+        }
+
+        /**
+         * Finds the first target attribute with a known name.
+         *
+         * @param id the parameter to look up
+         * @return the attribute, or nullptr if there is none
+         */
+        const TargetAttribute* attr(Param id) const {
+            std::size_t position = attributeIndex.find(id, targetAttributes);
+            return position < targetAttributes.size() ? &targetAttributes[position] : nullptr;
+        }
+
+        /**
+         * Finds the first target attribute with the given (lowercase) name.
+         *
+         * @param name the attribute name
+         * @return the attribute, or nullptr if there is none
+         */
+        const TargetAttribute* attr(StringView name) const {
+            Param id = knownParameter(name);
+            if(id != Param::Unknown)
+                return attr(id);
+            for(const auto &attribute : targetAttributes) {
+                if(StringView(attribute.name) == name)
+                    return &attribute;
+            }
+            return nullptr;
+        }
+
+        bool operator==(const Link &rhs) const {
+            return linkContext == rhs.linkContext &&
+                   linkRelation == rhs.linkRelation &&
+                   linkTarget == rhs.linkTarget &&
+                   targetAttributes == rhs.targetAttributes;
+        }
+
+        bool operator!=(const Link &rhs) const {
             return !(rhs == *this);
         }
     };
 
     /**
-     * Parses a quoted string.
-     *
-     * Given input, return an unquoted string. input is modified to remove the parsed string.
-     *
-     * @param input current value of the header string
-     * @return unquoted string
+     * The links produced from a single link-value. They only differ in their
+     * relation type, so they share one context, target and list of target
+     * attributes instead of each carrying a copy.
      */
-    inline std::string parseQuotedString(std::string &input) {
+    class LinkGroup {
+    public:
+        std::string linkContext;
+        std::string linkTarget;
+        std::vector<TargetAttribute> targetAttributes;
 
-        // 1. Let output be an empty string.
-        std::string output;
+        /** the (lowercase) relation types, one per link */
+        std::vector<std::string> linkRelations;
 
-        // 2. If the first character of input is not DQUOTE, return output.
-        if (input[0] != '"')
-            return output;
+        /** the identifiers of linkRelations, see relationId() and Link::linkRelationId */
+        std::vector<RelationId> linkRelationIds;
+
+        /** index of targetAttributes, see Link::attributeIndex */
+        AttributeIndex attributeIndex;
+
+        /** the number of links in this group */
+        std::size_t size() const {
+            return linkRelations.size();
+        }
+
+        /**
+         * @return a copy of the i-th link of this group
+         */
+        Link link(std::size_t i) const {
+            return Link{linkContext, linkRelations[i], linkTarget, targetAttributes, linkRelationIds[i]};
+        }
+
+        /**
+         * Finds the first target attribute with a known name.
+         *
+         * @param id the parameter to look up
+         * @return the attribute, or nullptr if there is none
+         */
+        const TargetAttribute* attr(Param id) const {
+            std::size_t position = attributeIndex.find(id, targetAttributes);
+            return position < targetAttributes.size() ? &targetAttributes[position] : nullptr;
+        }
+
+        void clear() {
+            linkContext.clear();
+            linkTarget.clear();
+            targetAttributes.clear();
+            linkRelations.clear();
+            linkRelationIds.clear();
+            attributeIndex.clear();
+        }
+    };
 
-        // 3. Discard the first character.
-        input = input.substr(1);
+    namespace detail {
 
-        // 4. While input has content:
-        while(!input.empty()) {
+        /**
+         * Scans a quoted string (Appendix B.4) without copying it.
+         *
+         * p must point at the opening DQUOTE. raw is set to the characters
+         * between the quotes, still backslash-escaped.
+         *
+         * @return pointer to the first character after the quoted string
+         */
+        inline const char* scanQuotedString(const char *p, const char *end, StringView &raw) {
 
-            // 4.1. If the first character is a backslash ("\"):
-            if (input[0] == '\\') {
+            // 3. Discard the first character.
+            const char *begin = ++p;
 
-                // 4.1.1. Discard the first character.
-                input = input.substr(1);
+            // 4. While input has content:
+            while(p != end) {
 
-                // 4.1.2. If there is no more input, return output.
-                if(input.empty())
-                    return output;
+                // 4.1. If the first character is a backslash ("\"), discard it
+                //      and consume the next character, if there is one.
+                if(*p == '\\') {
+                    if(++p == end)
+                        break;
+                    ++p;
+                }
 
-                // 4.1.3. Else, consume the first character and append it to
-                // output.
-                output.push_back(input[0]);
-                input = input.substr(1);
-            }
+                // 4.2. Else, if the first character is DQUOTE, discard it and
+                //      return output.
+                else if(*p == '"') {
+                    raw = StringView(begin, static_cast<std::size_t>(p - begin));
+                    return p + 1;
+                }
 
-            // 4.2. Else, if the first character is DQUOTE, discard it and return
-            // output.
-            else if (input[0] == '"') {
-                input = input.substr(1);
-                return output;
+                // 4.3. Else, consume the first character.
+                else
+                    ++p;
             }
 
-            // 4.3. Else, consume the first character and append it to output.
-            else {
-                output.push_back(input[0]);
-                input = input.substr(1);
+            raw = StringView(begin, static_cast<std::size_t>(end - begin));
+            return end;
+        }
+
+        /**
+         * Appends the unescaped form of a range found by scanQuotedString().
+         */
+        inline void appendUnescaped(StringView raw, std::string &output) {
+            output.reserve(output.size() + raw.size());
+            for(const char *p = raw.begin(); p != raw.end(); ++p) {
+                // 4.1.2. If there is no more input after a backslash, stop.
+                if(*p == '\\' && ++p == raw.end())
+                    break;
+                output.push_back(*p);
             }
         }
 
-        // 5. Return output.
-        return output;
-    }
+        /**
+         * A parameter as found in the header, before any normalisation.
+         */
+        class RawParameter {
+        public:
+            StringView name;
+            StringView value;
+            bool quoted;
+            Param id;
+        };
 
-    inline std::vector<TargetAttribute> parseParameters(std::string & input) {
+        /**
+         * Scans parameters (Appendix B.3) without copying them, calling
+         * handler with each RawParameter in order.
+         *
+         * @return pointer to the first character that was not consumed
+         */
+        template<typename Handler>
+        inline const char* scanParameters(const char *p, const char *end, Handler &&handler) {
 
-        std::string whitespace = " \t";
+            // 2. While input has content:
+            while(p != end) {
 
-        // 1. Let parameters be an empty list
-        std::vector<TargetAttribute> parameters;
+                // 2.1. Consume any leading OWS.
+                p = skipWhitespace(p, end);
 
-        // 2. While input has content:
-        while(!input.empty()) {
-
-            // 2.1. Consume any leading OWS.
-            auto strBegin = input.find_first_not_of(whitespace);
-            if(strBegin != std::string::npos)
-                input = input.substr(strBegin);
-
-            // 2.2. If the first character is not ";", return parameters.
-            if (input[0] != ';')
-                return parameters;
-
-            // 2.3. Discard the leading ";" character.
-            input = input.substr(1);
-
-            // 2.4. Consume any leading OWS.
-            strBegin = input.find_first_not_of(whitespace);
-            if(strBegin != std::string::npos)
-                input = input.substr(strBegin);
-
-            // 2.5. Consume up to but not including the first BWS, "=", ";", or
-            //  "," character, or up to the end of input, and let the result
-            //  be parameter_name.
-            std::string stopChars = " \t=;,";
-            strBegin = input.find_first_of(stopChars);
-            std::string parameter_name = input.substr(0, strBegin);
-            input = input.substr(strBegin);
-
-            // 2.6.   Consume any leading BWS.
-            strBegin = input.find_first_not_of(whitespace);
-            if(strBegin != std::string::npos)
-                input = input.substr(strBegin);
-            else
-                // the rest of input is just whitespace, so get rid of it
-                input = "";
+                // 2.2. If the first character is not ";", return parameters.
+                if(p == end || *p != ';')
+                    return p;
 
-            std::string parameter_value;
+                // 2.3. Discard the leading ";" character.
+                ++p;
 
-            // 2.7. If the next character is "=":
-            if (input[0] == '=') {
-                // 2.7.1. Discard the leading "=" character.
-                input = input.substr(1);
+                // 2.4. Consume any leading OWS.
+                p = skipWhitespace(p, end);
 
-                // 2.7.2. Consume any leading BWS.
-                strBegin = input.find_first_not_of(whitespace);
-                if(strBegin != std::string::npos)
-                    input = input.substr(strBegin);
-                else
-                    // the rest of input is just whitespace, so get rid of it
-                    input = "";
-
-                // 2.7.3. If the next character is DQUOTE, let parameter_value be
-                //        the result of Parsing a Quoted String (Appendix B.4)
-                //        from input (consuming zero or more characters of it).
-                if(input[0] == '"') {
-                    parameter_value = parseQuotedString(input);
-                }
+                // 2.5. Consume up to but not including the first BWS, "=", ";", or
+                //  "," character, or up to the end of input, and let the result
+                //  be parameter_name.
+                const char *name = p;
+                while(p != end && !isWhitespace(*p) && *p != '=' && *p != ';' && *p != ',')
+                    ++p;
 
-                // 2.7.4. Else, consume the contents up to but not including the
-                //        first ";" or "," character, or up to the end of input,
-                //        and let the results be parameter_value.
-                else {
-                    stopChars = ";,";
-                    strBegin = input.find_first_of(stopChars);
-                    if(strBegin != std::string::npos) {
-                        parameter_value = input.substr(0, strBegin);
-                        input = input.substr(strBegin);
-                    } else {
-                        parameter_value = input;
-                        input = "";
-                    }
-                }
+                RawParameter param{StringView(name, static_cast<std::size_t>(p - name)), StringView(name, 0), false,
+                                   Param::Unknown};
+                param.id = knownParameter(param.name);
 
-                // 2.7.5. If the last character of parameter_name is an asterisk
-                //        ("*"), decode parameter_value according to [RFC8187].
-                //        Continue processing input if an unrecoverable error is
-                //        encountered.
-                if(parameter_name[parameter_name.size()-1] == '*') {
-                    // todo ...
-                }
-            }
-            else {
-                // 2.8. Else:
-                // 2.8.1. Let parameter_value be an empty string.
-                parameter_value = "";
-            }
+                // 2.6.   Consume any leading BWS.
+                p = skipWhitespace(p, end);
 
-            // 2.9. Case-normalise parameter_name to lowercase.
-            std::transform(parameter_name.begin(), parameter_name.end(),
-                           parameter_name.begin(), &::tolower);
+                // 2.7. If the next character is "=":
+                if(p != end && *p == '=') {
+                    // 2.7.1. Discard the leading "=" character.
+                    ++p;
 
-            // 2.10. Append (parameter_name, parameter_value) to parameters.
-            parameters.push_back(TargetAttribute{parameter_name, parameter_value});
+                    // 2.7.2. Consume any leading BWS.
+                    p = skipWhitespace(p, end);
 
-            // 2.11. Consume any leading OWS.
-            strBegin = input.find_first_not_of(whitespace);
-            if(strBegin != std::string::npos)
-                input = input.substr(strBegin);
+                    // 2.7.3. If the next character is DQUOTE, let parameter_value be
+                    //        the result of Parsing a Quoted String (Appendix B.4)
+                    //        from input (consuming zero or more characters of it).
+                    if(p != end && *p == '"') {
+                        param.quoted = true;
+                        p = scanQuotedString(p, end, param.value);
+                    }
 
-            // 2.12. If the next character is "," or the end of input, stop
-            //       processing input and return parameters.
-            if(input.empty())
-                return parameters;
-            if(input[0] == ',') {
-                input = input.substr(1);
-                return parameters;
-            }
-        }
+                    // 2.7.4. Else, consume the contents up to but not including the
+                    //        first ";" or "," character, or up to the end of input,
+                    //        and let the results be parameter_value.
+                    else {
+                        const char *value = p;
+                        while(p != end && *p != ';' && *p != ',')
+                            ++p;
+                        param.value = StringView(value, static_cast<std::size_t>(p - value));
+                    }
 
-        return parameters;
-    }
+                    // 2.7.5. If the last character of parameter_name is an asterisk
+                    //        ("*"), decode parameter_value according to [RFC8187].
+                    //        Continue processing input if an unrecoverable error is
+                    //        encountered.
+                    // todo ...
+                }
 
-    /**
-     * Parses zero or more comma-separated link-values from a Link header field
-     *
-     * @param linkHeaderField string containing the value of a Link header field
-     *
-     * @return vector of zero or more Link objects
-     */
-    inline std::vector<Link> parse(const std::string& linkHeaderField, const std::string &baseUri = "") {
+                // 2.8. Else, parameter_value is the empty string.
 
-        std::vector<Link> links;
+                // 2.9. and 2.10. (case-normalising parameter_name and appending
+                //      the tuple to parameters) are left to handler.
+                handler(param);
+
+                // 2.11. Consume any leading OWS.
+                p = skipWhitespace(p, end);
 
-        std::string whitespace = " \t";
+                // 2.12. If the next character is "," or the end of input, stop
+                //       processing input and return parameters.
+                if(p == end)
+                    return p;
+                if(*p == ',')
+                    return p + 1;
+            }
 
-        std::string field_value = linkHeaderField;
+            return p;
+        }
 
-        while(!field_value.empty()) {
+        /**
+         * Scans steps 1 to 7 of a single link-value (Appendix B.2) without
+         * copying it. On success p is advanced past the link-value and its
+         * parameters, target refers to target_string, and handler has been
+         * called for each parameter.
+         *
+         * @return false if the field value has no further well-formed
+         *         link-value (steps 2 and 5), with p at the first character
+         *         that is not OWS
+         */
+        template<typename Handler>
+        inline bool scanLinkValue(const char *&p, const char *end, StringView &target, Handler &&handler) {
 
-            // 1. Consume any leading OWS
-            auto strBegin = field_value.find_first_not_of(whitespace);
-            if(strBegin != std::string::npos)
-                field_value = field_value.substr(strBegin);
+            // 1. Consume any leading OWS.
+            p = skipWhitespace(p, end);
 
             // 2. If the first character is not "<", return links.
-            if(field_value[0] != '<')
-                return links;
+            if(p == end || *p != '<')
+                return false;
 
             // 3. Discard the first character ("<").
             // 4. Consume up to but not including the first ">" character or
             //    end of field_value and let the result be target_string.
-            auto strEnd = field_value.find_first_of('>');
-            std::string target_string = field_value.substr(1, strEnd-1);
-            field_value = field_value.substr(strEnd);
+            const char *targetBegin = p + 1;
+            const char *targetEnd = static_cast<const char*>(
+                    std::memchr(targetBegin, '>', static_cast<std::size_t>(end - targetBegin)));
 
             // 5. If the next character is not ">", return links.
-            if(field_value[0] != '>')
-                return links;
+            if(!targetEnd)
+                return false;
+            target = StringView(targetBegin, static_cast<std::size_t>(targetEnd - targetBegin));
 
             // 6. Discard the leading ">" character.
-            field_value = field_value.substr(1);
+            // A link-value without parameters ends at a ",", which step 2.2
+            // of Parsing Parameters would leave for step 2 of the next
+            // link-value to trip over, so consume it here.
+            const char *rest = skipWhitespace(targetEnd + 1, end);
+            if(rest != end && *rest == ',') {
+                p = rest + 1;
+                return true;
+            }
 
             // 7. Let link_parameters be the result of Parsing Parameters
             //    (Appendix B.3) from field_value (consuming zero or more
             //    characters of it).
-            std::vector<TargetAttribute> link_parameters =
-                    parseParameters(field_value);
-
-            // 8. Let target_uri be the result of relatively resolving (as per
-            //   [RFC3986], Section 5.2) target_string.  Note that any base
-            //   URI carried in the payload body is NOT used.
-            std::string target_uri;
-            if(!uri::resolve(&baseUri, &target_string, &target_uri))
-                target_uri = target_string;
-
-            // 9. Let relations_string be the second item of the first tuple
-            //    of link_parameters whose first item matches the string "rel"
-            //    or the empty string ("") if it is not present.
-            std::string relations_string;
-            for(const auto& e : link_parameters) {
-                if(e.name == "rel") {
-                    relations_string = e.value;
-                    continue;
-                }
-            }
-
-            // 10. Split relations_string on RWS (removing it in the process)
-            //     into a list of string relation_types.
-            std::vector<std::string> relation_types;
-            if(relations_string.find_first_of(whitespace) != std::string::npos) {
-                while ((strEnd = relations_string.find_first_of(whitespace)) != std::string::npos) {
-                    std::string relation_type = relations_string.substr(0, strEnd);
-                    relations_string = relations_string.substr(strEnd + 1);
-                    relation_types.push_back(relation_type);
-                }
-                if (!relations_string.empty())
-                    relation_types.push_back(relations_string);
-            }
-            else
-                relation_types.push_back(relations_string);
-
-            // 11. Let context_string be the second item of the first tuple of
-            //     link_parameters whose first item matches the string
-            //     "anchor".  If it is not present, context_string is the URL
-            //     of the representation carrying the Link header [RFC7231],
-            //     Section 3.1.4.1, serialised as a URI.  Where the URL is
-            //     anonymous, context_string is null.
-            std::string context_string;
-            for(const auto& e : link_parameters) {
-                if(e.name == "anchor") {
-                    context_string = e.value;
-                    continue;
-                }
-            }
-
-            // 12. Let context_uri be the result of relatively resolving (as
-            //     per [RFC3986], Section 5.2) context_string, unless
-            //     context_string is null, in which case context is null.  Note
-            //     that any base URI carried in the payload body is NOT used.
-            std::string context_uri;
-            if(!uri::resolve(&baseUri, &context_string, &context_uri))
-                context_uri = context_string;
+            p = scanParameters(rest, end, handler);
+            return true;
+        }
 
-            // 13. Let target_attributes be an empty list.
-            std::vector<TargetAttribute> target_attributes;
+        /**
+         * Converts a RawParameter into a TargetAttribute (steps 2.9 and 2.10
+         * of Appendix B.3).
+         */
+        inline TargetAttribute toTargetAttribute(const RawParameter &param) {
+            TargetAttribute attribute;
+            attribute.id = param.id;
 
-            // 14. For each tuple (param_name, param_value) of link_parameters:
-            for(const auto& param : link_parameters) {
+            // 2.9. Case-normalise parameter_name to lowercase.
+            attribute.name.reserve(param.name.size());
+            for(char c : param.name)
+                attribute.name.push_back(toLower(c));
 
-                // 14.1. If param_name matches "rel" or "anchor", skip this tuple.
-                if(param.name == "rel" || param.name == "anchor")
-                    continue;
+            if(param.quoted)
+                appendUnescaped(param.value, attribute.value);
+            else
+                attribute.value.assign(param.value.begin(), param.value.end());
 
-                // 14.2. If param_name matches "media", "title", "title*", or
-                //       "type" and target_attributes already contains a tuple
-                //       whose first element matches the value of param_name,
-                //       skip this tuple.
-                if(param.name == "media" ||
-                   param.name == "title" ||
-                   param.name == "title*" ||
-                   param.name == "type") {
-                    for(const auto& a : target_attributes)
-                        if(a.name == param.name)
-                            continue;
-                }
+            return attribute;
+        }
 
-                // 14.3. Append (param_name, param_value) to target_attributes.
-                target_attributes.push_back(param);
+        /**
+         * Splits relations_string on RWS (step 10 of Appendix B.2), calling
+         * handler with each relation type. An empty (or all whitespace)
+         * relations_string yields a single empty relation type.
+         */
+        template<typename Handler>
+        inline void splitRelations(StringView relations, Handler &&handler) {
+            const char *p = relations.begin();
+            const char *end = relations.end();
+            bool found = false;
+            while((p = skipWhitespace(p, end)) != end) {
+                const char *type = p;
+                while(p != end && !isWhitespace(*p))
+                    ++p;
+                handler(StringView(type, static_cast<std::size_t>(p - type)));
+                found = true;
             }
+            if(!found)
+                handler(StringView());
+        }
+
+        /**
+         * Steps 16.1 to 16.4 of Appendix B.2 for all star_param_names at once.
+         */
+        inline void resolveStarParameters(std::vector<TargetAttribute> &target_attributes) {
 
-            // 15. Let star_param_names be the set of param_names in the
-            //     (param_name, param_value) tuples of target_attributes where
-            //     the last character of param_name is an asterisk ("*").
-            std::vector<std::string> star_param_names;
-            for(const auto& param : target_attributes)
-                if(param.name[param.name.size()-1] == '*')
-                    star_param_names.push_back(param.name);
+            // base_param_names of the star_param_names, as bits indexed by
+            // Param for known parameters and as strings otherwise
+            std::uint32_t known_bases = 0;
+            std::unordered_set<std::string> other_bases;
 
-            // 16. For each star_param_name in star_param_names:
-            for(const auto& star_param_name : star_param_names) {
+            for(const auto& param : target_attributes) {
+                if(param.name.empty() || param.name.back() != '*')
+                    continue;
 
                 // 16.1. Let base_param_name be star_param_name with the last
                 //       character removed.
-                std::string base_param_name =
-                        star_param_name.substr(0, star_param_name.size()-1);
+                StringView base_param_name(param.name.data(), param.name.size() - 1);
 
                 // 16.2. If the implementation does not choose to support an
                 //       internationalised form of a parameter named
@@ -471,55 +1491,1133 @@ namespace http_link_header {
                 //       next star_param_name.
                 // todo...
 
-                // 16.3. Remove all tuples from target_attributes whose first
-                //       member is base_param_name.
-                target_attributes.erase(
-                        std::remove_if(target_attributes.begin(), target_attributes.end(),
-                                       [&](const TargetAttribute &x) { return x.name == base_param_name; }),
-                        target_attributes.end());
-
-                // 16.4. Change the first member of all tuples in target_attributes
-                //       whose first member is star_param_name to base_param_name.
-                for(auto& param : target_attributes) {
-                    if(param.name == star_param_name)
-                        param.name = base_param_name;
-                }
+                Param base_id = knownParameter(base_param_name);
+                if(base_id != Param::Unknown)
+                    known_bases |= 1u << static_cast<unsigned>(base_id);
+                else
+                    other_bases.insert(base_param_name.str());
             }
 
-            // 17. For each relation_type in relation_types:
-            for(auto relation_type : relation_types) {
-                // 17.1. Case-normalise relation_type to lowercase.
-                std::transform(relation_type.begin(), relation_type.end(),
-                               relation_type.begin(), &::tolower);
-                // 17.2. Append a link object to links with the target
-                //       target_uri, relation type of relation_type, context of
-                //       context_uri, and target attributes target_attributes.
-                links.push_back(Link{context_uri, relation_type, target_uri, target_attributes});
+            // 16.3. Remove all tuples from target_attributes whose first
+            //       member is base_param_name.
+            target_attributes.erase(
+                    std::remove_if(target_attributes.begin(), target_attributes.end(),
+                                   [&](const TargetAttribute &x) {
+                                       if(!x.name.empty() && x.name.back() == '*')
+                                           return false;
+                                       if(x.id != Param::Unknown)
+                                           return (known_bases & (1u << static_cast<unsigned>(x.id))) != 0;
+                                       return !other_bases.empty() && other_bases.count(x.name) != 0;
+                                   }),
+                    target_attributes.end());
+
+            // 16.4. Change the first member of all tuples in target_attributes
+            //       whose first member is star_param_name to base_param_name.
+            for(auto& param : target_attributes) {
+                if(!param.name.empty() && param.name.back() == '*') {
+                    param.name.pop_back();
+                    param.id = knownParameter(param.name);
+                }
             }
         }
 
-        return links;
     }
 
     /**
-     * Parse the Link header fields that a HTTP header set contains
+     * Parses a quoted string.
      *
-     * @param headers vector of HTTP header strings
+     * Given input, return an unquoted string. input is modified to remove the parsed string.
      *
-     * @return vector of zero or more Link objects
+     * @param input current value of the header string
+     * @return unquoted string
      */
-    inline std::vector<Link> parse(const std::vector<std::string>& headers, const std::string &baseUri = "") {
-        std::vector<Link> links;
+    inline std::string parseQuotedString(std::string &input) {
 
-        if(headers.empty())
-            return links;
+        // 1. Let output be an empty string.
+        std::string output;
 
-        for(const auto& header : headers) {
-            std::vector<Link> headerLinks = parse(header, baseUri);
-            links.insert(links.end(), headerLinks.begin(), headerLinks.end());
+        // 2. If the first character of input is not DQUOTE, return output.
+        if (input.empty() || input[0] != '"')
+            return output;
+
+        StringView raw;
+        const char *begin = input.data();
+        const char *rest = detail::scanQuotedString(begin, begin + input.size(), raw);
+        detail::appendUnescaped(raw, output);
+        input.erase(0, static_cast<std::size_t>(rest - begin));
+
+        // 5. Return output.
+        return output;
+    }
+
+    /**
+     * Parses parameters.
+     *
+     * Given input, return a list of parameters. input is modified to remove the parsed parameters.
+     *
+     * @param input current value of the header string
+     * @return vector of parameters, in the order they were found
+     */
+    inline std::vector<TargetAttribute> parseParameters(std::string & input) {
+
+        // 1. Let parameters be an empty list
+        std::vector<TargetAttribute> parameters;
+
+        const char *begin = input.data();
+        const char *rest = detail::scanParameters(begin, begin + input.size(),
+                                                  [&](const detail::RawParameter &param) {
+            // 2.10. Append (parameter_name, parameter_value) to parameters.
+            parameters.push_back(detail::toTargetAttribute(param));
+        });
+        input.erase(0, static_cast<std::size_t>(rest - begin));
+
+        return parameters;
+    }
+
+    /**
+     * Why parsing a Link header field stopped before its end.
+     */
+    enum class ParseError : std::uint8_t {
+        /** the whole field value was parsed */
+        None,
+        /** a link-value does not start with "<" (step 2 of Appendix B.2) */
+        ExpectedTarget,
+        /** the target of a link-value has no closing ">" (step 5 of Appendix B.2) */
+        UnterminatedTarget,
+        /** memory, or another resource needed for the links, ran out */
+        OutOfMemory,
+        /** the field value is longer than ParseLimits::maxHeaderBytes */
+        HeaderTooLarge,
+        /** the field value has more than ParseLimits::maxLinks links */
+        TooManyLinks,
+        /** a link-value has more than ParseLimits::maxParametersPerLink parameters */
+        TooManyParameters,
+        /** a link-value has more than ParseLimits::maxRelationsPerLink relation types */
+        TooManyRelations,
+        /** a quoted string is longer than ParseLimits::maxQuotedStringLength */
+        QuotedStringTooLong,
+        /** a resolved target or context is longer than ParseLimits::maxResolvedUriLength */
+        UriTooLong,
+        /** the ParseBudget ran out */
+        BudgetExhausted,
+        /** parsing was cancelled through ParseOptions::cancelled */
+        Cancelled
+    };
+
+    /**
+     * @return a short English description of error
+     */
+    inline const char* errorMessage(ParseError error) noexcept {
+        switch(error) {
+            case ParseError::None:
+                return "no error";
+            case ParseError::ExpectedTarget:
+                return "expected \"<\" at the start of a link-value";
+            case ParseError::UnterminatedTarget:
+                return "missing \">\" after the target of a link-value";
+            case ParseError::OutOfMemory:
+                return "out of memory";
+            case ParseError::HeaderTooLarge:
+                return "the header field is too large";
+            case ParseError::TooManyLinks:
+                return "too many links";
+            case ParseError::TooManyParameters:
+                return "too many parameters in a link-value";
+            case ParseError::TooManyRelations:
+                return "too many relation types in a link-value";
+            case ParseError::QuotedStringTooLong:
+                return "a quoted string is too long";
+            case ParseError::UriTooLong:
+                return "a resolved URI is too long";
+            case ParseError::BudgetExhausted:
+                return "the work budget ran out";
+            case ParseError::Cancelled:
+                return "parsing was cancelled";
         }
+        return "unknown error";
+    }
 
-        return links;
+    /**
+     * Limits on the resources that parsing a Link header field may take, for
+     * headers from untrusted sources. Parsing stops with a ParseError when
+     * one is exceeded. By default there are no limits.
+     */
+    class ParseLimits {
+    public:
+        ParseLimits() noexcept
+                : maxHeaderBytes(SIZE_MAX), maxLinks(SIZE_MAX), maxParametersPerLink(SIZE_MAX),
+                  maxRelationsPerLink(SIZE_MAX), maxQuotedStringLength(SIZE_MAX), maxResolvedUriLength(SIZE_MAX) {}
+
+        /** the maximum size of the field value, checked before parsing it */
+        std::size_t maxHeaderBytes;
+
+        /** the maximum number of links, one per relation type as parse() returns them */
+        std::size_t maxLinks;
+
+        /** the maximum number of parameters of a link-value */
+        std::size_t maxParametersPerLink;
+
+        /** the maximum number of relation types in the "rel" parameter of a link-value */
+        std::size_t maxRelationsPerLink;
+
+        /** the maximum size of a quoted parameter value, counting escapes */
+        std::size_t maxQuotedStringLength;
+
+        /** the maximum size of a target or context after resolving it */
+        std::size_t maxResolvedUriLength;
+    };
+
+    /**
+     * The work that parsing a Link header field may do before it stops with
+     * ParseError::BudgetExhausted, to bound the time it takes. By default
+     * there is no budget.
+     */
+    class ParseBudget {
+    public:
+        ParseBudget() noexcept
+                : maxBytes(SIZE_MAX), maxResolutions(SIZE_MAX),
+                  deadline(std::chrono::steady_clock::time_point::max()) {}
+
+        /**
+         * the number of bytes of the field value to scan; parsing never reads
+         * past them, and stops before a link-value that reaches the last one
+         */
+        std::size_t maxBytes;
+
+        /** the number of URI references to resolve, two per link-value */
+        std::size_t maxResolutions;
+
+        /** the time after which no further link-value is started */
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    /**
+     * Options of tryParse() and tryParseGroups().
+     */
+    class ParseOptions {
+    public:
+        ParseOptions() noexcept : recover(false), limits(), budget(), cancelled(nullptr) {}
+
+        /**
+         * Skip malformed link-values instead of stopping at the first one:
+         * continue after the next comma that is not in a quoted string or a
+         * target, and report what was skipped. Exceeding a limit still
+         * stops parsing.
+         */
+        bool recover;
+
+        /** limits on the resources that parsing may take */
+        ParseLimits limits;
+
+        /** the work that parsing may do */
+        ParseBudget budget;
+
+        /**
+         * If set, parsing checks it before each link-value and stops with
+         * ParseError::Cancelled once it is true; see CancellationToken in
+         * http-link-header-parallel.h
+         */
+        const std::atomic<bool> *cancelled;
+    };
+
+    /**
+     * A part of a Link header field that was skipped in recovery mode.
+     */
+    class SkippedSpan {
+    public:
+        SkippedSpan(std::size_t spanOffset, std::size_t spanSize, ParseError spanError)
+                : offset(spanOffset), size(spanSize), error(spanError) {}
+
+        /** the byte offset into the field value of the malformed link-value */
+        std::size_t offset;
+
+        /** the number of bytes skipped, including the comma that ends them */
+        std::size_t size;
+
+        /** why the link-value could not be parsed */
+        ParseError error;
+    };
+
+    /**
+     * The result of tryParse(): the links of the link-values before the
+     * first error, and where and why parsing stopped.
+     */
+    class ParseResult {
+    public:
+        ParseResult() : links(), error(ParseError::None), offset(0), skipped() {}
+
+        std::vector<Link> links;
+
+        ParseError error;
+
+        /** the byte offset into the field value of the link-value that failed, or its size if none did */
+        std::size_t offset;
+
+        /** the malformed link-values skipped in recovery mode, in order */
+        std::vector<SkippedSpan> skipped;
+
+        /** did every link-value of the field value parse? */
+        bool ok() const noexcept {
+            return error == ParseError::None && skipped.empty();
+        }
+    };
+
+    /**
+     * The result of tryParseGroups(), see ParseResult.
+     */
+    class ParseGroupsResult {
+    public:
+        ParseGroupsResult() : groups(), error(ParseError::None), offset(0), skipped() {}
+
+        std::vector<LinkGroup> groups;
+
+        ParseError error;
+
+        /** the byte offset into the field value of the link-value that failed, or its size if none did */
+        std::size_t offset;
+
+        /** the malformed link-values skipped in recovery mode, in order */
+        std::vector<SkippedSpan> skipped;
+
+        /** did every link-value of the field value parse? */
+        bool ok() const noexcept {
+            return error == ParseError::None && skipped.empty();
+        }
+    };
+
+    namespace detail {
+
+        /**
+         * uri::resolve(), counted in the parse statistics.
+         */
+        inline bool resolveReference(const std::string &baseUri, const std::string &reference, std::string &result) {
+            bool resolved;
+            {
+                HLH_STATS_TIMER(ResolveNanoseconds);
+                resolved = uri::resolve(&baseUri, &reference, &result);
+            }
+            HLH_STATS_ADD(Resolutions, 1);
+            HLH_STATS_ADD(FailedResolutions, resolved ? 0 : 1);
+            return resolved;
+        }
+
+        /**
+         * @return why scanLinkValue() returned false with p where it left it
+         */
+        inline ParseError stopReason(const char *p, const char *end) noexcept {
+            if(p == end)
+                return ParseError::None;
+            return *p == '<' ? ParseError::UnterminatedTarget : ParseError::ExpectedTarget;
+        }
+
+        /**
+         * Parses a single link-value (steps 1 to 17.1 of Appendix B.2) into
+         * group, replacing its contents.
+         *
+         * @return false if the field value has no further well-formed
+         *         link-value or the link-value exceeds limits, with error
+         *         set to why (ParseError::None at the end of the field
+         *         value) and p where scanLinkValue() left it
+         */
+        inline bool parseLinkValue(const char *&p, const char *end, const std::string &baseUri,
+                                   const ParseLimits &limits, LinkGroup &group, ParseError &error) {
+
+            group.clear();
+
+            // 1. to 7. Consume the link-value up to and including its
+            //    parameters, letting the result be target_string and
+            //    link_parameters.
+            StringView target;
+            std::vector<TargetAttribute> link_parameters;
+            bool scanned;
+            error = ParseError::None;
+            HLH_TRACE_BEGIN(TokenizeLinkValue);
+            {
+                HLH_STATS_TIMER(TokenizeNanoseconds);
+                scanned = scanLinkValue(p, end, target, [&](const RawParameter &param) {
+                    // once over a limit the rest is only scanned, not copied
+                    if(error != ParseError::None)
+                        return;
+                    if(link_parameters.size() == limits.maxParametersPerLink)
+                        error = ParseError::TooManyParameters;
+                    else if(param.quoted && param.value.size() > limits.maxQuotedStringLength)
+                        error = ParseError::QuotedStringTooLong;
+                    else
+                        link_parameters.push_back(toTargetAttribute(param));
+                });
+            }
+            HLH_TRACE_END(TokenizeLinkValue);
+            if(!scanned) {
+                // only trailing whitespace is a clean end of the field value
+                error = stopReason(p, end);
+                HLH_STATS_ADD(EarlyExits, p != end ? 1 : 0);
+                return false;
+            }
+            if(error != ParseError::None)
+                return false;
+            HLH_STATS_ADD(Parameters, link_parameters.size());
+            std::string target_string = target.str();
+
+            // 8. Let target_uri be the result of relatively resolving (as per
+            //   [RFC3986], Section 5.2) target_string.  Note that any base
+            //   URI carried in the payload body is NOT used.
+            HLH_TRACE_BEGIN(ResolveTarget);
+            std::string target_uri;
+            if(!resolveReference(baseUri, target_string, target_uri))
+                target_uri = std::move(target_string);
+            HLH_TRACE_END(ResolveTarget);
+            if(target_uri.size() > limits.maxResolvedUriLength) {
+                error = ParseError::UriTooLong;
+                return false;
+            }
+
+            HLH_TRACE_BEGIN(ProcessParameters);
+
+            // 9. to 16. are done in a single pass over link_parameters.
+            const TargetAttribute *rel = nullptr;
+            const TargetAttribute *anchor = nullptr;
+
+            // 13. Let target_attributes be an empty list.
+            std::vector<TargetAttribute> target_attributes;
+            target_attributes.reserve(link_parameters.size());
+
+            // which of "media", "title", "title*" and "type" target_attributes
+            // already contains (14.2), as bits indexed by Param
+            std::uint32_t seen = 0;
+            bool has_star_param = false;
+
+            for(auto& param : link_parameters) {
+
+                // 9. Let relations_string be the second item of the first tuple
+                //    of link_parameters whose first item matches the string "rel"
+                //    or the empty string ("") if it is not present.
+                // 11. Let context_string be the second item of the first tuple of
+                //     link_parameters whose first item matches the string
+                //     "anchor".
+                // 14.1. If param_name matches "rel" or "anchor", skip this tuple.
+                if(param.id == Param::Rel) {
+                    if(!rel)
+                        rel = &param;
+                    continue;
+                }
+                if(param.id == Param::Anchor) {
+                    if(!anchor)
+                        anchor = &param;
+                    continue;
+                }
+
+                // 14.2. If param_name matches "media", "title", "title*", or
+                //       "type" and target_attributes already contains a tuple
+                //       whose first element matches the value of param_name,
+                //       skip this tuple.
+                if(param.id == Param::Media ||
+                   param.id == Param::Title ||
+                   param.id == Param::TitleStar ||
+                   param.id == Param::Type) {
+                    std::uint32_t bit = 1u << static_cast<unsigned>(param.id);
+                    if(seen & bit)
+                        continue;
+                    seen |= bit;
+                }
+
+                // 15. Let star_param_names be the set of param_names in the
+                //     (param_name, param_value) tuples of target_attributes where
+                //     the last character of param_name is an asterisk ("*").
+                if(!param.name.empty() && param.name.back() == '*') {
+                    HLH_STATS_ADD(StarParameters, 1);
+                    has_star_param = true;
+                }
+
+                // 14.3. Append (param_name, param_value) to target_attributes.
+                target_attributes.push_back(std::move(param));
+            }
+
+            // 10. Split relations_string on RWS (removing it in the process)
+            //     into a list of string relation_types.
+            StringView relations_string = rel ? StringView(rel->value) : StringView();
+
+            // 16. For each star_param_name in star_param_names:
+            if(has_star_param)
+                resolveStarParameters(target_attributes);
+            HLH_TRACE_END(ProcessParameters);
+
+            // 12. Let context_uri be the result of relatively resolving (as
+            //     per [RFC3986], Section 5.2) context_string, unless
+            //     context_string is null, in which case context is null.  Note
+            //     that any base URI carried in the payload body is NOT used.
+            //     If "anchor" is not present, context_string is the URL of the
+            //     representation carrying the Link header [RFC7231], Section
+            //     3.1.4.1, serialised as a URI.  Where the URL is anonymous,
+            //     context_string is null.
+            HLH_TRACE_BEGIN(ResolveContext);
+            std::string context_string = anchor ? anchor->value : std::string();
+            std::string context_uri;
+            if(!resolveReference(baseUri, context_string, context_uri))
+                context_uri = std::move(context_string);
+            HLH_TRACE_END(ResolveContext);
+            if(context_uri.size() > limits.maxResolvedUriLength) {
+                error = ParseError::UriTooLong;
+                return false;
+            }
+
+            // 17. For each relation_type in relation_types:
+            HLH_TRACE_BEGIN(ExpandRelations);
+            splitRelations(relations_string, [&](StringView type) {
+                if(group.linkRelations.size() == limits.maxRelationsPerLink) {
+                    error = ParseError::TooManyRelations;
+                    return;
+                }
+
+                // 17.1. Case-normalise relation_type to lowercase.
+                std::string relation_type;
+                relation_type.reserve(type.size());
+                for(char ch : type)
+                    relation_type.push_back(toLower(ch));
+
+                group.linkRelationIds.push_back(relationId(relation_type));
+                group.linkRelations.push_back(std::move(relation_type));
+            });
+            HLH_TRACE_END(ExpandRelations);
+            if(error != ParseError::None)
+                return false;
+
+            group.linkContext = std::move(context_uri);
+            group.linkTarget = std::move(target_uri);
+            group.targetAttributes = std::move(target_attributes);
+            group.attributeIndex.build(group.targetAttributes);
+            HLH_STATS_ADD(Links, group.size());
+            return true;
+        }
+
+        /**
+         * 17.2. Append a link object to links with the target target_uri,
+         *       relation type of relation_type, context of context_uri, and
+         *       target attributes target_attributes, for each relation_type.
+         *
+         * The last link takes over the storage of group.
+         */
+        inline void appendLinks(LinkGroup &group, std::vector<Link> &links) {
+            std::size_t count = group.size();
+            for(std::size_t i = 0; i + 1 < count; ++i)
+                links.push_back(group.link(i));
+            if(count != 0)
+                links.push_back(Link{std::move(group.linkContext), std::move(group.linkRelations[count - 1]),
+                                     std::move(group.linkTarget), std::move(group.targetAttributes),
+                                     group.linkRelationIds[count - 1]});
+        }
+
+        /**
+         * Parses each link-value with parseLinkValue(), for parseLinkValues().
+         */
+        class LinkValueParser {
+        public:
+            LinkValueParser(const std::string &parserBaseUri, const ParseLimits &parserLimits)
+                    : baseUri(parserBaseUri), limits(parserLimits) {}
+
+            bool operator()(const char *&p, const char *end, LinkGroup &group, ParseError &error) const {
+                return parseLinkValue(p, end, baseUri, limits, group, error);
+            }
+
+        private:
+            const std::string &baseUri;
+            const ParseLimits &limits;
+        };
+
+        /**
+         * Finds where to continue after a malformed link-value: the next
+         * comma that is not in a quoted string or a target.
+         *
+         * @return the comma, or end if there is none
+         */
+        inline const char* findNextLinkValue(const char *p, const char *end) {
+            while(p != end) {
+                if(*p == ',')
+                    return p;
+                if(*p == '<') {
+                    p = static_cast<const char*>(std::memchr(p + 1, '>', static_cast<std::size_t>(end - p - 1)));
+                    if(!p)
+                        return end;
+                }
+                else if(*p == '"') {
+                    StringView raw;
+                    p = scanQuotedString(p, end, raw);
+                    continue;
+                }
+                ++p;
+            }
+            return end;
+        }
+
+        /**
+         * Parses link-values from p with parse, which is called like
+         * parseLinkValue() without baseUri and limits, and calls emit(group)
+         * for each of them,
+         * up to the end of the field value, the first malformed link-value
+         * or the first link-value that exceeds options.limits, leaving p at
+         * either, or until options.budget runs out. With options.recover
+         * malformed link-values are added to skipped instead.
+         *
+         * p only moves past a link-value once it is emitted, so if an
+         * allocation fails p is at the link-value that was being parsed.
+         *
+         * @return why parsing stopped before the end, if it did
+         */
+        template<typename Parse, typename Emit>
+        inline ParseError parseLinkValues(const char *&p, const char *end, const ParseOptions &options,
+                                          std::vector<SkippedSpan> &skipped, Parse &&parse, Emit &&emit) {
+            const char *begin = p;
+            const ParseLimits &limits = options.limits;
+            ParseError error = ParseError::None;
+            if(static_cast<std::size_t>(end - p) > limits.maxHeaderBytes)
+                error = ParseError::HeaderTooLarge;
+
+            // the bytes budget is kept by never scanning past window; a
+            // link-value that reaches it may continue after it, so it only
+            // counts as parsed if it ends before
+            const ParseBudget &budget = options.budget;
+            const char *window = end;
+            if(static_cast<std::size_t>(end - p) > budget.maxBytes)
+                window = p + budget.maxBytes;
+            bool timed = budget.deadline != std::chrono::steady_clock::time_point::max();
+            std::size_t resolutions = 0;
+
+            std::size_t links = 0;
+            LinkGroup group;
+            while(p != end && error == ParseError::None) {
+                if(options.cancelled && options.cancelled->load(std::memory_order_relaxed)) {
+                    error = ParseError::Cancelled;
+                    break;
+                }
+                if(p == window || budget.maxResolutions - resolutions < 2 ||
+                   (timed && std::chrono::steady_clock::now() >= budget.deadline)) {
+                    error = ParseError::BudgetExhausted;
+                    break;
+                }
+
+                const char *next = p;
+                bool parsed = parse(next, window, group, error);
+                if(window != end) {
+                    bool cut = parsed ? next == window
+                                      : error == ParseError::None || error == ParseError::UnterminatedTarget;
+                    if(cut) {
+                        error = ParseError::BudgetExhausted;
+                        break;
+                    }
+                }
+
+                if(!parsed) {
+                    // exceeding a limit leaves p at the start of the link-value
+                    bool malformed = error == ParseError::ExpectedTarget || error == ParseError::UnterminatedTarget;
+                    if(error == ParseError::None || malformed)
+                        p = next;
+                    if(!malformed || !options.recover)
+                        break;
+
+                    const char *comma = findNextLinkValue(p, window);
+                    if(comma == window && window != end) {
+                        error = ParseError::BudgetExhausted;
+                        break;
+                    }
+                    next = comma == end ? end : comma + 1;
+                    skipped.push_back(SkippedSpan(static_cast<std::size_t>(p - begin),
+                                                  static_cast<std::size_t>(next - p), error));
+                    error = ParseError::None;
+                    p = next;
+                    continue;
+                }
+
+                resolutions += 2;
+                if(group.size() > limits.maxLinks - links) {
+                    error = ParseError::TooManyLinks;
+                    break;
+                }
+                links += group.size();
+                emit(group);
+                p = next;
+            }
+
+            HLH_STATS_ADD(Headers, 1);
+            HLH_STATS_ADD(Bytes, static_cast<std::size_t>(p - begin));
+            return error;
+        }
+
+        /**
+         * Parses link-values from p into groups, see parseLinkValues().
+         */
+        inline ParseError parseGroupsInto(const char *&p, const char *end, const std::string &baseUri,
+                                          const ParseOptions &options, std::vector<SkippedSpan> &skipped,
+                                          std::vector<LinkGroup> &groups) {
+            return parseLinkValues(p, end, options, skipped, LinkValueParser(baseUri, options.limits),
+                                   [&](LinkGroup &group) {
+                groups.push_back(std::move(group));
+            });
+        }
+
+        /**
+         * Parses link-values from p into links, see parseLinkValues().
+         */
+        template<typename Parse>
+        inline ParseError parseLinksInto(const char *&p, const char *end, const ParseOptions &options,
+                                         std::vector<SkippedSpan> &skipped, Parse &&parse,
+                                         std::vector<Link> &links) {
+            return parseLinkValues(p, end, options, skipped, std::forward<Parse>(parse), [&](LinkGroup &group) {
+                HLH_TRACE_BEGIN(AppendLinks);
+                appendLinks(group, links);
+                HLH_TRACE_END(AppendLinks);
+            });
+        }
+
+        /**
+         * tryParse() into result with parse, see parseLinkValues(), reusing
+         * the storage result already has.
+         */
+        template<typename Parse>
+        inline void tryParseInto(StringView linkHeaderField, const ParseOptions &options, Parse &&parse,
+                                 ParseResult &result) noexcept {
+            result.links.clear();
+            result.skipped.clear();
+
+            const char *p = linkHeaderField.begin();
+            const char *end = linkHeaderField.end();
+#ifdef HLH_EXCEPTIONS
+            try {
+#endif
+                result.error = parseLinksInto(p, end, options, result.skipped, std::forward<Parse>(parse),
+                                              result.links);
+#ifdef HLH_EXCEPTIONS
+            } catch(...) {
+                result.links.clear();
+                result.skipped.clear();
+                result.error = ParseError::OutOfMemory;
+            }
+#endif
+            result.offset = static_cast<std::size_t>(p - linkHeaderField.begin());
+        }
+
+        /**
+         * tryParse() into result, reusing the storage it already has.
+         */
+        inline void tryParseInto(StringView linkHeaderField, const std::string &baseUri, const ParseOptions &options,
+                                 ParseResult &result) noexcept {
+            tryParseInto(linkHeaderField, options, LinkValueParser(baseUri, options.limits), result);
+        }
+
+    }
+
+    /**
+     * Parses zero or more comma-separated link-values from a Link header field
+     * into groups of links that share their target, context and attributes.
+     *
+     * @param linkHeaderField string containing the value of a Link header field
+     * @param baseUri the URI to resolve relative references against
+     *
+     * @return vector of zero or more LinkGroup objects, one per link-value
+     */
+    inline std::vector<LinkGroup> parseGroups(const std::string& linkHeaderField, const std::string &baseUri = "") {
+
+        std::vector<LinkGroup> groups;
+
+        const char *p = linkHeaderField.data();
+        std::vector<SkippedSpan> skipped;
+        detail::parseGroupsInto(p, p + linkHeaderField.size(), baseUri, ParseOptions(), skipped, groups);
+        return groups;
+    }
+
+    /**
+     * Parses a Link header field into groups like parseGroups(), and reports
+     * where and why it stopped if it did not reach the end.
+     *
+     * @param linkHeaderField string containing the value of a Link header field
+     * @param baseUri the URI to resolve relative references against
+     * @param options whether to skip malformed link-values, see ParseOptions
+     *
+     * @return the groups of the link-values before the first error, or of
+     *         all well-formed link-values in recovery mode, which are none
+     *         if the error is ParseError::OutOfMemory
+     */
+    inline ParseGroupsResult tryParseGroups(const std::string& linkHeaderField, const std::string &baseUri = "",
+                                            const ParseOptions &options = ParseOptions()) noexcept {
+
+        ParseGroupsResult result;
+
+        const char *p = linkHeaderField.data();
+        const char *end = p + linkHeaderField.size();
+#ifdef HLH_EXCEPTIONS
+        try {
+#endif
+            result.error = detail::parseGroupsInto(p, end, baseUri, options, result.skipped, result.groups);
+#ifdef HLH_EXCEPTIONS
+        } catch(...) {
+            result.groups.clear();
+            result.skipped.clear();
+            result.error = ParseError::OutOfMemory;
+        }
+#endif
+        result.offset = static_cast<std::size_t>(p - linkHeaderField.data());
+        return result;
+    }
+
+    /**
+     * Expands groups of links into one Link per relation type.
+     *
+     * @param groups the result of parseGroups()
+     *
+     * @return the same links that parse() returns for the same header
+     */
+    inline std::vector<Link> expand(const std::vector<LinkGroup>& groups) {
+        std::vector<Link> links;
+        for(const auto& group : groups) {
+            for(std::size_t i = 0; i < group.size(); ++i)
+                links.push_back(group.link(i));
+        }
+        return links;
+    }
+
+    /**
+     * Parses zero or more comma-separated link-values from a Link header field
+     *
+     * @param linkHeaderField string containing the value of a Link header field
+     *
+     * @return vector of zero or more Link objects
+     */
+    inline std::vector<Link> parse(const std::string& linkHeaderField, const std::string &baseUri = "") {
+
+        std::vector<Link> links;
+
+        const char *p = linkHeaderField.data();
+        std::vector<SkippedSpan> skipped;
+        ParseOptions options;
+        detail::parseLinksInto(p, p + linkHeaderField.size(), options, skipped,
+                               detail::LinkValueParser(baseUri, options.limits), links);
+        return links;
+    }
+
+    /**
+     * Parses a Link header field like parse(), and reports where and why it
+     * stopped if it did not reach the end.
+     *
+     * @param linkHeaderField string containing the value of a Link header field
+     * @param baseUri the URI to resolve relative references against
+     * @param options whether to skip malformed link-values, see ParseOptions
+     *
+     * @return the links of the link-values before the first error, or of
+     *         all well-formed link-values in recovery mode, which are none
+     *         if the error is ParseError::OutOfMemory
+     */
+    inline ParseResult tryParse(const std::string& linkHeaderField, const std::string &baseUri = "",
+                                const ParseOptions &options = ParseOptions()) noexcept {
+        ParseResult result;
+        detail::tryParseInto(linkHeaderField, baseUri, options, result);
+        return result;
+    }
+
+    /**
+     * Parse the Link header fields that a HTTP header set contains
+     *
+     * @param headers vector of HTTP header strings
+     *
+     * @return vector of zero or more Link objects
+     */
+    inline std::vector<Link> parse(const std::vector<std::string>& headers, const std::string &baseUri = "") {
+        std::vector<Link> links;
+
+        if(headers.empty())
+            return links;
+
+        for(const auto& header : headers) {
+            std::vector<Link> headerLinks = parse(header, baseUri);
+            links.insert(links.end(), std::make_move_iterator(headerLinks.begin()),
+                         std::make_move_iterator(headerLinks.end()));
+        }
+
+        return links;
+    }
+
+    namespace detail {
+
+        /**
+         * Finds the end of the line at p in an HTTP/1.1 header section,
+         * accepting a bare LF as line break as well as CRLF.
+         *
+         * @param next set to the start of the next line, or end
+         * @return the end of the line, before its line break
+         */
+        inline const char* findLineEnd(const char *p, const char *end, const char *&next) {
+            const char *lf = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+            if(!lf) {
+                next = end;
+                return end;
+            }
+            next = lf + 1;
+            return lf != p && lf[-1] == '\r' ? lf - 1 : lf;
+        }
+
+    }
+
+    /**
+     * Parses the Link header fields of a raw HTTP/1.1 header section, without
+     * splitting it into header fields first. Field names are matched ignoring
+     * case, and field values are parsed where they are unless they are
+     * folded onto several lines (obs-fold), which are joined with spaces
+     * into a copy. The header section ends at the first empty line, or the
+     * end of the buffer; a start line before it is ignored.
+     *
+     * @param buf the header section, e.g. as received
+     * @param len the size of buf in bytes
+     * @param baseUri the URI to resolve relative references against
+     *
+     * @return the links of all Link header fields, like parse() for each
+     */
+    inline std::vector<Link> parse_from_header_block(const char *buf, std::size_t len,
+                                                     const std::string &baseUri = "") {
+        std::vector<Link> links;
+        ParseOptions options;
+        detail::LinkValueParser parser(baseUri, options.limits);
+        std::vector<SkippedSpan> skipped;
+        std::string unfolded;
+
+        const char *end = buf + len;
+        const char *next;
+        for(const char *line = buf; line != end; line = next) {
+            const char *lineEnd = detail::findLineEnd(line, end, next);
+            if(line == lineEnd)
+                break;
+
+            // the field name must be followed by ":" right away
+            if(lineEnd - line < 5 || !detail::equalsLowercase(StringView(line, 4), "link") || line[4] != ':')
+                continue;
+
+            // lines that start with whitespace continue the field value
+            const char *valueEnd = lineEnd;
+            while(next != end && detail::isWhitespace(*next))
+                valueEnd = detail::findLineEnd(next, end, next);
+
+            const char *p = line + 5;
+            if(valueEnd == lineEnd) {
+                detail::parseLinksInto(p, valueEnd, options, skipped, parser, links);
+                continue;
+            }
+
+            // replace each obs-fold by spaces, as RFC 7230, Section 3.2.4 asks
+            unfolded.assign(p, valueEnd);
+            for(std::size_t i = 0; i < unfolded.size(); ++i) {
+                if(unfolded[i] == '\n' || (unfolded[i] == '\r' && i + 1 < unfolded.size() && unfolded[i + 1] == '\n'))
+                    unfolded[i] = ' ';
+            }
+            p = unfolded.data();
+            detail::parseLinksInto(p, p + unfolded.size(), options, skipped, parser, links);
+        }
+
+        return links;
+    }
+
+    /**
+     * The state that a thread keeps from one tryParse() to the next, to
+     * parse many header fields without allocating for each: the base URI,
+     * which adjacent header fields often share, and the storage of the
+     * result.
+     */
+    class ParseContext {
+    public:
+        ParseContext() : baseUri_() {}
+
+        /**
+         * Parses a Link header field like tryParse() into result, reusing
+         * the storage it already has.
+         */
+        void parse(StringView linkHeaderField, StringView baseUri, const ParseOptions &options,
+                   ParseResult &result) noexcept {
+            if(baseUri != baseUri_) {
+#ifdef HLH_EXCEPTIONS
+                try {
+#endif
+                    baseUri_.assign(baseUri.begin(), baseUri.end());
+#ifdef HLH_EXCEPTIONS
+                } catch(...) {
+                    baseUri_.clear();
+                    result.links.clear();
+                    result.skipped.clear();
+                    result.error = ParseError::OutOfMemory;
+                    result.offset = 0;
+                    return;
+                }
+#endif
+            }
+            detail::tryParseInto(linkHeaderField, baseUri_, options, result);
+        }
+
+    private:
+        std::string baseUri_;
+    };
+
+    /**
+     * A pagination link found by extract_pagination().
+     *
+     * All views point into the header string that was scanned.
+     */
+    class PageLink {
+    public:
+        /** was a link with this relation type found? */
+        bool found;
+
+        /** the target exactly as it appears between "<" and ">" (not resolved) */
+        StringView target;
+
+        /**
+         * the numeric value of a "page" query parameter of target, or -1 if
+         * there is none, it is not a number or it has more than 18 digits
+         */
+        long long page;
+
+        /** the raw (still percent-encoded) value of a "cursor" query parameter of target */
+        StringView cursor;
+    };
+
+    /**
+     * The "first", "prev", "next" and "last" links of a paginated response.
+     */
+    class Pagination {
+    public:
+        PageLink first;
+        PageLink prev;
+        PageLink next;
+        PageLink last;
+    };
+
+    namespace detail {
+
+        /**
+         * Compares a (possibly backslash-escaped) token against a lowercase
+         * literal, ignoring ASCII case.
+         */
+        inline bool tokenEquals(StringView token, bool escaped, const char *literal) {
+            for(const char *p = token.begin(); p != token.end(); ++p, ++literal) {
+                if(escaped && *p == '\\' && ++p == token.end())
+                    break;
+                if(*literal == '\0' || toLower(*p) != *literal)
+                    return false;
+            }
+            return *literal == '\0';
+        }
+
+        /**
+         * Fills in the page and cursor members of link from the query
+         * component of its target. Only the first "page" and the first
+         * "cursor" count, even if their value is not a number or empty.
+         */
+        inline void parsePageQuery(PageLink &link) {
+            const char *p = static_cast<const char*>(
+                    std::memchr(link.target.data(), '?', link.target.size()));
+            if(!p)
+                return;
+            const char *end = static_cast<const char*>(
+                    std::memchr(p, '#', static_cast<std::size_t>(link.target.end() - p)));
+            if(!end)
+                end = link.target.end();
+
+            bool pageSeen = false;
+            while(p != end) {
+                const char *key = ++p;
+                while(p != end && *p != '&')
+                    ++p;
+                const char *eq = static_cast<const char*>(
+                        std::memchr(key, '=', static_cast<std::size_t>(p - key)));
+                const char *valueBegin = eq ? eq + 1 : p;
+                StringView name(key, static_cast<std::size_t>((eq ? eq : p) - key));
+                StringView value(valueBegin, static_cast<std::size_t>(p - valueBegin));
+
+                if(name == "page" && !pageSeen) {
+                    pageSeen = true;
+                    // 18 digits always fit in a long long
+                    if(value.empty() || value.size() >= 19)
+                        continue;
+                    long long page = 0;
+                    for(char c : value) {
+                        if(c < '0' || c > '9') {
+                            page = -1;
+                            break;
+                        }
+                        page = page * 10 + (c - '0');
+                    }
+                    link.page = page;
+                }
+                else if(name == "cursor" && !link.cursor.data())
+                    link.cursor = value;
+            }
+        }
+
+    }
+
+    /**
+     * Extracts the pagination links ("first", "prev"/"previous", "next" and
+     * "last") from a Link header field, as sent by GitHub-style APIs.
+     *
+     * This is a specialised, allocation-free scan over the same tokenizer
+     * used by parse(). Targets are not resolved against a base URI and the
+     * first link carrying a given relation type wins. The returned views
+     * point into linkHeaderField, which must outlive them.
+     *
+     * @param linkHeaderField the value of a Link header field
+     *
+     * @return the pagination links, each with found set if present
+     */
+    inline Pagination extract_pagination(StringView linkHeaderField) noexcept {
+
+        Pagination pagination{};
+        PageLink *slots[] = {&pagination.first, &pagination.prev, &pagination.next, &pagination.last};
+        for(PageLink *slot : slots)
+            slot->page = -1;
+
+        const char *p = linkHeaderField.begin();
+        const char *end = linkHeaderField.end();
+
+        while(p != end) {
+            StringView target;
+            detail::RawParameter rel{};
+            bool hasRel = false;
+            if(!detail::scanLinkValue(p, end, target, [&](const detail::RawParameter &param) {
+                if(!hasRel && param.id == Param::Rel) {
+                    rel = param;
+                    hasRel = true;
+                }
+            }))
+                break;
+
+            // split the relation types on whitespace, which may be escaped
+            // in a quoted string, and classify each one
+            const char *r = rel.value.begin();
+            const char *relEnd = rel.value.end();
+            auto unescaped = [&](const char *c) {
+                return rel.quoted && *c == '\\' && c + 1 != relEnd ? c + 1 : c;
+            };
+            while(r != relEnd) {
+                while(r != relEnd && detail::isWhitespace(*unescaped(r)))
+                    r = unescaped(r) + 1;
+                const char *token = r;
+                while(r != relEnd && !detail::isWhitespace(*unescaped(r)))
+                    r = unescaped(r) + 1;
+                StringView type(token, static_cast<std::size_t>(r - token));
+
+                PageLink *slot = nullptr;
+                if(detail::tokenEquals(type, rel.quoted, "next"))
+                    slot = &pagination.next;
+                else if(detail::tokenEquals(type, rel.quoted, "prev") ||
+                        detail::tokenEquals(type, rel.quoted, "previous"))
+                    slot = &pagination.prev;
+                else if(detail::tokenEquals(type, rel.quoted, "first"))
+                    slot = &pagination.first;
+                else if(detail::tokenEquals(type, rel.quoted, "last"))
+                    slot = &pagination.last;
+
+                if(slot && !slot->found) {
+                    slot->found = true;
+                    slot->target = target;
+                    detail::parsePageQuery(*slot);
+                }
+            }
+        }
+
+        return pagination;
     }
 
 }
@@ -0,0 +1,49 @@
+// Counting of heap allocations, for asserting allocation budgets in tests
+//
+// The counts come from the replacement global operator new in
+// allocation_tests.cpp and only include allocations made by the current
+// thread.
+
+#ifndef HLH_TEST_ALLOCATION_COUNTER_H
+#define HLH_TEST_ALLOCATION_COUNTER_H
+
+#include <cstddef>
+
+namespace allocation_counter {
+
+    /** number of calls to operator new on this thread so far */
+    std::size_t count();
+
+    /** number of bytes requested from operator new on this thread so far */
+    std::size_t bytes();
+
+    /**
+     * Makes every allocation on this thread from the allocation-th one on
+     * (counting as count() does) throw std::bad_alloc, for testing the
+     * handling of running out of memory. failFrom(SIZE_MAX) turns it off.
+     */
+    void failFrom(std::size_t allocation);
+
+    /**
+     * Counts the allocations made on this thread during its lifetime.
+     */
+    class Scope {
+    public:
+        Scope() : count_(count()), bytes_(bytes()) {}
+
+        std::size_t allocations() const {
+            return count() - count_;
+        }
+
+        std::size_t allocatedBytes() const {
+            return bytes() - bytes_;
+        }
+
+    private:
+        std::size_t count_;
+        std::size_t bytes_;
+    };
+
+}
+
+#endif //HLH_TEST_ALLOCATION_COUNTER_H
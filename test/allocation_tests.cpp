@@ -0,0 +1,270 @@
+// This file contains tests that check allocation budgets of the parser
+
+#include "http-link-header.h"
+#include "allocation_counter.h"
+#include "doctest.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+    thread_local std::size_t allocations = 0;
+    thread_local std::size_t allocated_bytes = 0;
+    thread_local std::size_t fail_from = SIZE_MAX;
+
+    void* allocate(std::size_t size) {
+        if(allocations >= fail_from)
+            throw std::bad_alloc();
+        ++allocations;
+        allocated_bytes += size;
+        if(void *p = std::malloc(size ? size : 1))
+            return p;
+        throw std::bad_alloc();
+    }
+
+}
+
+std::size_t allocation_counter::count() {
+    return allocations;
+}
+
+std::size_t allocation_counter::bytes() {
+    return allocated_bytes;
+}
+
+void allocation_counter::failFrom(std::size_t allocation) {
+    fail_from = allocation;
+}
+
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+
+static std::string header_single = // NOLINT(cert-err58-cpp)
+        R"(<https://example.com/TheBook/chapter2>; rel="previous"; title="previous chapter")";
+
+static std::string header_pagination = // NOLINT(cert-err58-cpp)
+        R"(<https://api.github.com/repositories/1300192/issues?page=2>; rel="prev", )"
+        R"(<https://api.github.com/repositories/1300192/issues?page=4>; rel="next", )"
+        R"(<https://api.github.com/repositories/1300192/issues?page=515>; rel="last", )"
+        R"(<https://api.github.com/repositories/1300192/issues?page=1>; rel="first")";
+
+TEST_CASE("allocation counter counts allocations") {
+    allocation_counter::Scope scope;
+    std::unique_ptr<std::string> s(new std::string(100, 'x'));
+
+    CHECK(scope.allocations() == 2);
+    CHECK(scope.allocatedBytes() > 100);
+}
+
+TEST_CASE("allocation budget, extract_pagination allocates nothing") {
+    allocation_counter::Scope scope;
+    auto pagination = http_link_header::extract_pagination(header_pagination);
+
+    CHECK(pagination.last.page == 515);
+    CHECK(scope.allocations() == 0);
+}
+
+TEST_CASE("allocation budget, scanning a cached header allocates nothing") {
+    allocation_counter::Scope scope;
+    const char *p = header_pagination.data();
+    const char *end = p + header_pagination.size();
+    std::size_t links = 0;
+    std::size_t parameters = 0;
+    http_link_header::StringView target;
+    while(p != end && http_link_header::detail::scanLinkValue(p, end, target, [&](
+            const http_link_header::detail::RawParameter &) { ++parameters; }))
+        ++links;
+
+    CHECK(links == 4);
+    CHECK(parameters == 4);
+    CHECK(scope.allocations() == 0);
+}
+
+TEST_CASE("allocation budget, classifying relation types and parameters allocates nothing") {
+    allocation_counter::Scope scope;
+
+    CHECK(http_link_header::registeredRelation("Preload") == http_link_header::Relation::Preload);
+    CHECK(http_link_header::registeredRelation("http://example.net/foo") == http_link_header::Relation::Extension);
+    CHECK(http_link_header::knownParameter("HREFLANG") == http_link_header::Param::Hreflang);
+    CHECK(scope.allocations() == 0);
+}
+
+TEST_CASE("allocation budget, parseQuotedString") {
+    std::string input = R"("previous chapter")";
+    allocation_counter::Scope scope;
+    auto value = http_link_header::parseQuotedString(input);
+
+    CHECK(value == "previous chapter");
+    // the output string
+    CHECK(scope.allocations() <= 1);
+}
+
+TEST_CASE("allocation budget, parseParameters") {
+    std::string input = R"(; rel="previous"; title="previous chapter")";
+    allocation_counter::Scope scope;
+    auto parameters = http_link_header::parseParameters(input);
+
+    CHECK(parameters.size() == 2);
+    // the vector, which grows once, and the one value too long for the
+    // small string buffer
+    CHECK(scope.allocations() <= 3);
+}
+
+TEST_CASE("allocation budget, uri::resolve") {
+    std::string base = "https://example.org/a/b";
+    std::string relative = "../privacy";
+    std::string result;
+    result.reserve(64);
+    allocation_counter::Scope scope;
+
+    CHECK(http_link_header::uri::resolve(&base, &relative, &result));
+    CHECK(result == "https://example.org/privacy");
+    // the result is written in place, and uriparser allocates with malloc
+    CHECK(scope.allocations() == 0);
+}
+
+TEST_CASE("allocation budget, parse one link") {
+    allocation_counter::Scope scope;
+    auto links = http_link_header::parse(header_single);
+
+    CHECK(links.size() == 1);
+    CHECK(scope.allocations() <= 8);
+}
+
+TEST_CASE("allocation budget, parseGroups with many relation types") {
+    std::string header = R"(</style.css>; rel="preload prefetch alternate stylesheet"; title="a long enough title")";
+    allocation_counter::Scope scope;
+    auto groups = http_link_header::parseGroups(header);
+
+    CHECK(groups[0].size() == 4);
+    // the attributes are not copied per relation type
+    CHECK(scope.allocations() <= 12);
+}
+
+namespace {
+
+    /** bytes allocated by parse(header) */
+    std::size_t parseBytes(const std::string &header) {
+        allocation_counter::Scope scope;
+        auto links = http_link_header::parse(header);
+        return scope.allocatedBytes();
+    }
+
+    /** bytes allocated by parseGroups(header) */
+    std::size_t parseGroupsBytes(const std::string &header) {
+        allocation_counter::Scope scope;
+        auto groups = http_link_header::parseGroups(header);
+        return scope.allocatedBytes();
+    }
+
+}
+
+TEST_CASE("allocated memory grows linearly with adversarial input") {
+    std::string links, relations, escapes, parameters;
+    std::string links4, relations4, escapes4, parameters4;
+    for(std::size_t i = 0; i < 4000; ++i) {
+        std::string link = (i ? ", </" : "</") + std::to_string(i) + ">; rel=next";
+        // a registered relation type, so the table of interned extension
+        // relation types neither grows nor fills up
+        std::string relation = " next";
+        std::string parameter = "; p" + std::to_string(i) + "=v";
+        if(i < 1000) {
+            links += link;
+            relations += relation;
+            escapes += "\\\"";
+            parameters += parameter;
+        }
+        links4 += link;
+        relations4 += relation;
+        escapes4 += "\\\"";
+        parameters4 += parameter;
+    }
+
+    // four times the input may take at most six times the memory
+    CHECK(parseBytes(links4) <= 6 * parseBytes(links));
+    CHECK(parseBytes("<x>; rel=\"" + relations4 + "\"") <= 6 * parseBytes("<x>; rel=\"" + relations + "\""));
+    CHECK(parseBytes("<x>; title=\"" + escapes4 + "\"") <= 6 * parseBytes("<x>; title=\"" + escapes + "\""));
+
+    // parse() copies the attributes into every link, parseGroups() does not
+    CHECK(parseGroupsBytes("<x>; rel=\"" + relations4 + "\"" + parameters4) <=
+          6 * parseGroupsBytes("<x>; rel=\"" + relations + "\"" + parameters));
+}
+
+TEST_CASE("tryParse reports running out of memory at the link-value it was parsing") {
+    std::string header = header_pagination;
+    std::string baseUri = "https://example.org/";
+    auto expected = http_link_header::parse(header, baseUri);
+
+    // fail each allocation of tryParse() in turn, until it needs no more
+    bool failed = false;
+    for(std::size_t n = 0;; ++n) {
+        allocation_counter::failFrom(allocation_counter::count() + n);
+        auto result = http_link_header::tryParse(header, baseUri);
+        allocation_counter::failFrom(SIZE_MAX);
+
+        if(result.ok()) {
+            CHECK(result.links == expected);
+            break;
+        }
+        failed = true;
+        REQUIRE(result.error == http_link_header::ParseError::OutOfMemory);
+        CHECK(result.links.empty());
+        CHECK(result.offset < header.size());
+        CHECK((result.offset == 0 || header[result.offset - 1] == ','));
+    }
+    CHECK(failed);
+}
+
+TEST_CASE("allocation budget, exceeding a limit stops before copying the link-value") {
+    std::string header = "</a>; rel=\"";
+    for(int i = 0; i < 10000; ++i)
+        header += " r" + std::to_string(i);
+    header += "\"";
+    for(int i = 0; i < 10000; ++i)
+        header += "; p" + std::to_string(i) + "=v";
+
+    http_link_header::ParseOptions options;
+    options.limits.maxParametersPerLink = 8;
+    {
+        allocation_counter::Scope scope;
+        auto result = http_link_header::tryParse(header, "", options);
+
+        CHECK(result.error == http_link_header::ParseError::TooManyParameters);
+        CHECK(scope.allocations() < 40);
+    }
+
+    // the parameters are copied once, but not into a link per relation type
+    options.limits = http_link_header::ParseLimits();
+    options.limits.maxRelationsPerLink = 8;
+    {
+        allocation_counter::Scope scope;
+        auto result = http_link_header::tryParse(header, "", options);
+
+        CHECK(result.error == http_link_header::ParseError::TooManyRelations);
+        CHECK(scope.allocations() < 10000 + 100);
+    }
+}
@@ -0,0 +1,122 @@
+// This file contains tests for parse_async() and CancellationToken
+
+#include "http-link-header-parallel.h"
+#include "doctest.h"
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    /** runs each task on a thread of its own */
+    class ThreadExecutor {
+    public:
+        ~ThreadExecutor() {
+            for(auto &thread : threads)
+                thread.join();
+        }
+
+        void operator()(std::function<void()> task) {
+            threads.emplace_back(std::move(task));
+        }
+
+        std::vector<std::thread> threads;
+    };
+
+    /** keeps the tasks to run them later */
+    class DeferredExecutor {
+    public:
+        void operator()(std::function<void()> task) {
+            tasks.push_back(std::move(task));
+        }
+
+        void runAll() {
+            for(auto &task : tasks)
+                task();
+            tasks.clear();
+        }
+
+        std::vector<std::function<void()>> tasks;
+    };
+
+    std::string largeHeader() {
+        std::string header;
+        for(int i = 0; i < 20000; ++i) {
+            if(i != 0)
+                header += ", ";
+            header += "</" + std::to_string(i) + R"(>; rel="preload"; as=script)";
+        }
+        return header;
+    }
+
+}
+
+TEST_CASE("parse_async gives the result of tryParse") {
+    std::string header = R"(</a>; rel="next last", oops, </b>; rel=prev)";
+    http_link_header::ParseOptions options;
+    options.recover = true;
+    auto expected = http_link_header::tryParse(header, "https://example.org/x/", options);
+
+    ThreadExecutor executor;
+    auto future = http_link_header::parse_async(header, "https://example.org/x/", executor,
+                                                http_link_header::CancellationToken(), options);
+    auto result = future.get();
+
+    CHECK(result.links == expected.links);
+    CHECK(result.skipped.size() == 1);
+    CHECK(result.error == http_link_header::ParseError::None);
+
+    // an executor may run the task right away
+    auto immediate = http_link_header::parse_async(header, "", [](std::function<void()> task) { task(); });
+    CHECK(immediate.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    CHECK(immediate.get().error == http_link_header::ParseError::ExpectedTarget);
+}
+
+TEST_CASE("parse_async cancelled before it runs ends at once") {
+    DeferredExecutor executor;
+    http_link_header::CancellationToken token;
+    auto future = http_link_header::parse_async(largeHeader(), "", executor, token);
+
+    CHECK_FALSE(token.cancelled());
+    token.cancel();
+    CHECK(token.cancelled());
+    executor.runAll();
+
+    auto result = future.get();
+    CHECK(result.error == http_link_header::ParseError::Cancelled);
+    CHECK(result.offset == 0);
+    CHECK(result.links.empty());
+}
+
+TEST_CASE("parse_async cancelled while it runs stops with the links so far") {
+    std::string header = largeHeader();
+    auto all = http_link_header::tryParse(header);
+
+    ThreadExecutor executor;
+    http_link_header::CancellationToken token;
+    auto future = http_link_header::parse_async(header, "", executor, token);
+    token.cancel();
+    auto result = future.get();
+
+    // the parse may also have finished before it saw the cancellation
+    if(result.error == http_link_header::ParseError::Cancelled) {
+        CHECK(result.links.size() < all.links.size());
+        CHECK(std::equal(result.links.begin(), result.links.end(), all.links.begin()));
+        CHECK((result.offset == 0 || header[result.offset - 1] == ','));
+    }
+    else
+        CHECK(result.links == all.links);
+}
+
+TEST_CASE("parse_async reports a task that the executor dropped") {
+    std::future<http_link_header::ParseResult> future;
+    {
+        DeferredExecutor executor;
+        future = http_link_header::parse_async("</a>", "", executor);
+    }
+    CHECK_THROWS_AS(future.get(), std::future_error);
+}
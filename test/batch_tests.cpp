@@ -0,0 +1,219 @@
+// This file contains tests for parse_batch(), parse_parallel() and the
+// ThreadPool they run on
+
+#include "http-link-header-parallel.h"
+#include "doctest.h"
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    const char *const headers[] = {
+            R"(<https://example.com/TheBook/chapter2>; rel="previous"; title="previous chapter")",
+            R"(</a>; rel="next LAST http://example.net/shared-relation"; type=text/html, </b>; rel=first)",
+            R"(</terms>; rel="copyright"; anchor="#foo", <../styles/main.css>; rel=preload; as=style)",
+            R"(</a>; rel=next, oops; rel=prev, </c>; rel=last)",
+            R"(</a>; rel=next, <unterminated; rel=prev)",
+            ""};
+
+    const char *const baseUris[] = {"https://example.org/a/b", "", "http://x/"};
+
+    bool same(const http_link_header::ParseResult &a, const http_link_header::ParseResult &b) {
+        if(a.links != b.links || a.error != b.error || a.offset != b.offset || a.skipped.size() != b.skipped.size())
+            return false;
+        for(std::size_t i = 0; i < a.links.size(); ++i) {
+            if(!a.links[i].sameRelation(b.links[i]))
+                return false;
+        }
+        for(std::size_t i = 0; i < a.skipped.size(); ++i) {
+            if(a.skipped[i].offset != b.skipped[i].offset || a.skipped[i].size != b.skipped[i].size)
+                return false;
+        }
+        return true;
+    }
+
+}
+
+TEST_CASE("parallelFor runs every iteration once") {
+    for(unsigned threads : {1u, 2u, 3u, 8u}) {
+        http_link_header::ThreadPool pool(threads);
+        CHECK(pool.size() == threads);
+
+        for(std::size_t count : {0, 1, 2, 7, 1000, 100000}) {
+            std::vector<std::atomic<int>> runs(count);
+            for(auto &r : runs)
+                r.store(0);
+            pool.parallelFor(count, [&](std::size_t begin, std::size_t end) {
+                for(std::size_t i = begin; i < end; ++i)
+                    ++runs[i];
+            });
+
+            int wrong = 0;
+            for(auto &r : runs)
+                wrong += r.load() != 1;
+            CHECK(wrong == 0);
+        }
+    }
+}
+
+TEST_CASE("parallelFor balances uneven iterations") {
+    http_link_header::ThreadPool pool(4);
+    std::vector<std::thread::id> ranOn(4000);
+
+    // the first quarter of the iterations, which is the calling thread's
+    // range, does nearly all the work; sleeping lets the other threads
+    // steal from it even on a single core
+    pool.parallelFor(ranOn.size(), [&](std::size_t begin, std::size_t end) {
+        for(std::size_t i = begin; i < end; ++i) {
+            if(i < 1000)
+                std::this_thread::sleep_for(std::chrono::microseconds(20));
+            ranOn[i] = std::this_thread::get_id();
+        }
+    });
+
+    std::set<std::thread::id> heavy(ranOn.begin(), ranOn.begin() + 1000);
+    CHECK(heavy.count(std::thread::id()) == 0);
+    CHECK(heavy.size() > 1);
+}
+
+TEST_CASE("parse_batch gives the results of tryParse") {
+    std::vector<std::string> strings;
+    std::vector<std::string> bases;
+    for(int i = 0; i < 3000; ++i) {
+        strings.push_back(headers[i % (sizeof(headers) / sizeof(headers[0]))]);
+        bases.push_back(baseUris[(i / 7) % (sizeof(baseUris) / sizeof(baseUris[0]))]);
+    }
+    std::vector<http_link_header::HeaderRef> refs;
+    for(std::size_t i = 0; i < strings.size(); ++i)
+        refs.push_back(http_link_header::HeaderRef(strings[i], bases[i]));
+
+    http_link_header::ParseOptions options;
+    for(bool recover : {false, true}) {
+        options.recover = recover;
+        std::vector<http_link_header::ParseResult> expected;
+        for(std::size_t i = 0; i < strings.size(); ++i)
+            expected.push_back(http_link_header::tryParse(strings[i], bases[i], options));
+
+        for(unsigned threads : {1u, 4u}) {
+            http_link_header::ThreadPool pool(threads);
+            auto results = http_link_header::parse_batch(refs, pool, options);
+
+            REQUIRE(results.size() == expected.size());
+            int mismatches = 0;
+            for(std::size_t i = 0; i < results.size(); ++i)
+                mismatches += !same(results[i], expected[i]);
+            CHECK(mismatches == 0);
+        }
+    }
+}
+
+TEST_CASE("parse_batch overwrites the results it is given") {
+    http_link_header::ThreadPool pool(2);
+    std::string header = R"(</a>; rel=next, x)";
+    http_link_header::HeaderRef refs[] = {http_link_header::HeaderRef(header),
+                                          http_link_header::HeaderRef(header, "http://x/y")};
+    std::vector<http_link_header::ParseResult> results(2);
+    results[0].links.resize(5);
+    results[1].skipped.push_back(http_link_header::SkippedSpan(1, 2, http_link_header::ParseError::ExpectedTarget));
+
+    for(int round = 0; round < 3; ++round) {
+        http_link_header::parse_batch(refs, 2, results.data(), pool);
+
+        CHECK(results[0].links.size() == 1);
+        CHECK(results[0].links[0].linkTarget == "/a");
+        CHECK(results[1].links[0].linkTarget == "http://x/a");
+        CHECK(results[1].skipped.empty());
+        CHECK(results[1].error == http_link_header::ParseError::ExpectedTarget);
+    }
+}
+
+TEST_CASE("parse_batch with an empty batch does nothing") {
+    http_link_header::ThreadPool pool(2);
+    CHECK(http_link_header::parse_batch(std::vector<http_link_header::HeaderRef>(), pool).empty());
+}
+
+namespace {
+
+    // link-values and pieces of them, well-formed or not, some with commas
+    // and "<" where the structural pass of parse_parallel() does not expect them
+    const char *const fragments[] = {
+            R"(</a>; rel=next)",
+            R"(<https://example.com/b>; rel="prev first"; title="a, <b>, c")",
+            R"(<../c?d=e,f>; anchor="#g"; title*=UTF-8'de'n%c3%a4chstes)",
+            R"(</h>; p=a<b)",
+            R"(q=c>d; rel=last)",
+            R"(oops)",
+            R"(<unterminated)",
+            R"("quoted, string)",
+            R"(</i>; title="unterminated, quoted)",
+            R"()",
+            R"(  </j>  ;  rel = preload ; as = style  )"};
+
+    std::string randomHeader(std::mt19937 &random, std::size_t count) {
+        std::uniform_int_distribution<std::size_t> pick(0, sizeof(fragments) / sizeof(fragments[0]) - 1);
+        std::string header;
+        for(std::size_t i = 0; i < count; ++i) {
+            if(i != 0)
+                header += random() % 8 == 0 ? " , " : ", ";
+            header += fragments[pick(random)];
+        }
+        return header;
+    }
+
+}
+
+TEST_CASE("parse_parallel gives the result of tryParse for a large header") {
+    std::string header;
+    for(int i = 0; i < 5000; ++i) {
+        if(i != 0)
+            header += ", ";
+        header += "</style/" + std::to_string(i) + R"(.css>; rel="preload stylesheet"; as=style; title="a, <b>")";
+    }
+
+    http_link_header::ThreadPool pool(4);
+    for(const char *base : {"", "https://example.com/a/b"}) {
+        auto expected = http_link_header::tryParse(header, base);
+        auto result = http_link_header::parse_parallel(header, base, pool);
+
+        CHECK(expected.links.size() == 10000);
+        std::string target = *base ? "https://example.com/style/4999.css" : "/style/4999.css";
+        CHECK(expected.links[9999].linkTarget == target);
+        CHECK(same(result, expected));
+    }
+}
+
+TEST_CASE("parse_parallel gives the result of tryParse for any header and options") {
+    std::mt19937 random(47);
+    http_link_header::ThreadPool pool(3);
+    http_link_header::ThreadPool single(1);
+
+    int mismatches = 0;
+    for(int round = 0; round < 2000; ++round) {
+        std::string header = randomHeader(random, random() % 40);
+        http_link_header::ParseOptions options;
+        options.recover = random() % 2 == 0;
+        if(random() % 4 == 0)
+            options.budget.maxBytes = random() % (header.size() + 1);
+        if(random() % 4 == 0)
+            options.budget.maxResolutions = random() % 40;
+        if(random() % 4 == 0)
+            options.limits.maxLinks = random() % 20;
+        if(random() % 4 == 0)
+            options.limits.maxParametersPerLink = random() % 4;
+        if(random() % 8 == 0)
+            options.limits.maxHeaderBytes = random() % (header.size() + 1);
+        std::string base = random() % 2 == 0 ? "" : "http://example.org/x/y";
+
+        auto expected = http_link_header::tryParse(header, base, options);
+        std::size_t segmentBytes = 1 + random() % 64;
+        mismatches += !same(http_link_header::parse_parallel(header, base, pool, options, segmentBytes), expected);
+        mismatches += !same(http_link_header::parse_parallel(header, base, single, options, segmentBytes), expected);
+    }
+    CHECK(mismatches == 0);
+}
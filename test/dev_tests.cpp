@@ -378,3 +378,187 @@ TEST_CASE("badly formed parameters, missing start quote for relations") {
     CHECK(links[1].targetAttributes.empty());
 }
 
+
+TEST_CASE("badly formed parameters, name at end of input") {
+    auto links = http_link_header::parse(R"(<http://example.org>; a)");
+
+    CHECK(links.size() == 1);
+
+    CHECK(links[0].targetAttributes.size() == 1);
+    CHECK(links[0].targetAttributes[0].name == "a");
+    CHECK(links[0].targetAttributes[0].value == "");
+}
+
+TEST_CASE("badly formed link, missing end of target") {
+    auto links = http_link_header::parse(R"(<http://example.org>; rel="one", <http://example.org/two)");
+
+    CHECK(links.size() == 1);
+    CHECK(links[0].linkRelation == "one");
+}
+
+TEST_CASE("parse parameters, input is consumed up to the next link-value") {
+    std::string input = R"(; a=1; b="two", <http://example.org>)";
+    auto parameters = http_link_header::parseParameters(input);
+
+    CHECK(parameters.size() == 2);
+    CHECK(parameters[1].value == "two");
+    CHECK(input == " <http://example.org>");
+}
+
+TEST_CASE("parse quoted value, trailing backslash") {
+    std::string input = "\"abc\\";
+    CHECK(http_link_header::parseQuotedString(input) == "abc");
+    CHECK(input.empty());
+}
+
+TEST_CASE("classify known parameter names") {
+    using http_link_header::Param;
+
+    CHECK(http_link_header::knownParameter("rel") == Param::Rel);
+    CHECK(http_link_header::knownParameter("REV") == Param::Rev);
+    CHECK(http_link_header::knownParameter("Anchor") == Param::Anchor);
+    CHECK(http_link_header::knownParameter("title") == Param::Title);
+    CHECK(http_link_header::knownParameter("title*") == Param::TitleStar);
+    CHECK(http_link_header::knownParameter("hreflang") == Param::Hreflang);
+    CHECK(http_link_header::knownParameter("crossorigin") == Param::Crossorigin);
+    CHECK(http_link_header::knownParameter("") == Param::Unknown);
+    CHECK(http_link_header::knownParameter("titles") == Param::Unknown);
+    CHECK(http_link_header::knownParameter("foo") == Param::Unknown);
+}
+
+TEST_CASE("parsed target attributes carry their parameter id") {
+    auto links = http_link_header::parse(R"(<http://example.org>; TYPE="text/html"; foo=bar)");
+
+    CHECK(links.size() == 1);
+    CHECK(links[0].targetAttributes[0].id == http_link_header::Param::Type);
+    CHECK(links[0].targetAttributes[1].id == http_link_header::Param::Unknown);
+}
+
+TEST_CASE("look up target attributes of a Link") {
+    using http_link_header::Param;
+
+    auto links = http_link_header::parse(
+            R"(<http://example.org>; rel=alternate; hreflang=de; type="text/html"; hreflang=fr; foo=bar)");
+
+    CHECK(links.size() == 1);
+    REQUIRE(links[0].attr(Param::Type) != nullptr);
+    CHECK(links[0].attr(Param::Type)->value == "text/html");
+    CHECK(links[0].attr(Param::Hreflang)->value == "de");
+    CHECK(links[0].attr(Param::Media) == nullptr);
+    CHECK(links[0].attr("foo")->value == "bar");
+    CHECK(links[0].attr("hreflang")->value == "de");
+    CHECK(links[0].attr("bar") == nullptr);
+}
+
+TEST_CASE("look up target attributes after changing them") {
+    using http_link_header::Param;
+
+    http_link_header::Link link{"a", "b", "c", {{"title", "one"}}};
+    CHECK(link.attr(Param::Title)->value == "one");
+
+    link.targetAttributes.insert(link.targetAttributes.begin(), {"type", "text/plain"});
+    CHECK(link.attr(Param::Title)->value == "one");
+    CHECK(link.attr(Param::Type)->value == "text/plain");
+
+    link.indexAttributes();
+    CHECK(link.attr(Param::Title) == &link.targetAttributes[1]);
+}
+
+TEST_CASE("first rel parameter wins") {
+    auto links = http_link_header::parse(R"(<http://example.org>; rel="one"; rel="two")");
+
+    CHECK(links.size() == 1);
+    CHECK(links[0].linkRelation == "one");
+    CHECK(links[0].targetAttributes.empty());
+}
+
+TEST_CASE("first anchor parameter wins") {
+    auto links = http_link_header::parse(R"(<http://example.org>; anchor="#one"; rel=a; anchor="#two")",
+                                         "https://example.org/a/b");
+
+    CHECK(links.size() == 1);
+    CHECK(links[0].linkContext == "https://example.org/a/b#one");
+    CHECK(links[0].targetAttributes.empty());
+}
+
+TEST_CASE("only the first media, title and type attributes are kept") {
+    auto links = http_link_header::parse(
+            R"(<http://example.org>; title=a; type=b; foo=1; title=c; media=d; type=e; foo=2; media=f)");
+
+    CHECK(links.size() == 1);
+
+    auto &attributes = links[0].targetAttributes;
+    CHECK(attributes.size() == 5);
+    CHECK(attributes[0] == http_link_header::TargetAttribute{"title", "a"});
+    CHECK(attributes[1] == http_link_header::TargetAttribute{"type", "b"});
+    CHECK(attributes[2] == http_link_header::TargetAttribute{"foo", "1"});
+    CHECK(attributes[3] == http_link_header::TargetAttribute{"media", "d"});
+    CHECK(attributes[4] == http_link_header::TargetAttribute{"foo", "2"});
+}
+
+TEST_CASE("star parameters replace their base parameters") {
+    auto links = http_link_header::parse(
+            R"(<http://example.org>; title="plain"; foo=1; title*=UTF-8''star; bar*=x; bar=2; foo*=y)");
+
+    CHECK(links.size() == 1);
+
+    auto &attributes = links[0].targetAttributes;
+    CHECK(attributes.size() == 3);
+    CHECK(attributes[0] == http_link_header::TargetAttribute{"title", "UTF-8''star"});
+    CHECK(attributes[0].id == http_link_header::Param::Title);
+    CHECK(attributes[1] == http_link_header::TargetAttribute{"bar", "x"});
+    CHECK(attributes[2] == http_link_header::TargetAttribute{"foo", "y"});
+}
+
+TEST_CASE("relation types are split on runs of whitespace") {
+    auto links = http_link_header::parse("<http://example.org>; rel=\"  one \t two  \"");
+
+    CHECK(links.size() == 2);
+    CHECK(links[0].linkRelation == "one");
+    CHECK(links[1].linkRelation == "two");
+}
+
+TEST_CASE("parse link groups") {
+    auto groups = http_link_header::parseGroups(
+            R"(<style.css>; rel="preload Stylesheet"; as=style, <next>; rel=next)", "https://example.org/a/b");
+
+    CHECK(groups.size() == 2);
+
+    CHECK(groups[0].size() == 2);
+    CHECK(groups[0].linkContext == "https://example.org/a/b");
+    CHECK(groups[0].linkTarget == "https://example.org/a/style.css");
+    CHECK(groups[0].linkRelations[0] == "preload");
+    CHECK(groups[0].linkRelations[1] == "stylesheet");
+    CHECK(groups[0].linkRelationIds[1] == static_cast<http_link_header::RelationId>(http_link_header::Relation::Stylesheet));
+    CHECK(groups[0].attr(http_link_header::Param::As)->value == "style");
+
+    CHECK(groups[1].size() == 1);
+    CHECK(groups[1].link(0).linkRelation == "next");
+}
+
+TEST_CASE("expanding link groups gives the same links as parse") {
+    std::string header = R"(<a>; rel="one two three"; title=t; foo=bar, <b>, <c>; rel=four; anchor="#x")";
+    std::string baseUri = "https://example.org/";
+
+    CHECK(http_link_header::expand(http_link_header::parseGroups(header, baseUri)) ==
+          http_link_header::parse(header, baseUri));
+}
+
+TEST_CASE("stats are all zero unless compiled in") {
+    http_link_header::parse(header_previousChapter);
+    auto stats = http_link_header::stats();
+
+    CHECK_FALSE(http_link_header::Stats::enabled());
+    CHECK(stats.headers == 0);
+    CHECK(stats.links == 0);
+}
+
+TEST_CASE("tracing hook is not called unless compiled in") {
+    int calls = 0;
+    CHECK_FALSE(http_link_header::setTraceHook(
+            [](http_link_header::TracePhase, bool, void *context) { ++*static_cast<int*>(context); }, &calls));
+    http_link_header::parse(header_previousChapter);
+    http_link_header::setTraceHook(nullptr);
+
+    CHECK(calls == 0);
+}
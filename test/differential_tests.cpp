@@ -0,0 +1,470 @@
+// This file contains differential tests that check the optimized parse paths
+// against the reference implementation in reference_parser.h
+//
+// The inputs are generated from a fixed seed, so failures are reproducible.
+// Set HLH_DIFFERENTIAL_SEED and HLH_DIFFERENTIAL_ITERATIONS to explore more
+// of the input space.
+
+#include "http-link-header.h"
+#include "reference_parser.h"
+#include "doctest.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+    unsigned long environmentOr(const char *name, unsigned long fallback) {
+        const char *value = std::getenv(name);
+        return value && *value ? std::strtoul(value, nullptr, 10) : fallback;
+    }
+
+    class Random {
+    public:
+        explicit Random(unsigned long seed) : engine_(static_cast<std::mt19937::result_type>(seed)) {}
+
+        std::size_t below(std::size_t n) {
+            return std::uniform_int_distribution<std::size_t>(0, n - 1)(engine_);
+        }
+
+        bool chance(std::size_t percent) {
+            return below(100) < percent;
+        }
+
+        template<typename T, std::size_t N>
+        const T& pick(const T (&values)[N]) {
+            return values[below(N)];
+        }
+
+    private:
+        std::mt19937 engine_;
+    };
+
+    const char *const targets[] = {
+            "https://example.com/a", "/b/c", "../d", "", "?page=2", "#frag", "//host/p", "x y", "<", "a;b,c",
+            "https://api.example.com/items?page=3&cursor=abc", "/items?cursor=x%20y&page=07#p", "http://x/../../y"};
+    const char *const names[] = {
+            "rel", "REL", "Rel", "anchor", "ANCHOR", "title", "title*", "Title*", "type", "media", "hreflang",
+            "as", "crossorigin", "integrity", "nopush", "rev", "x", "x*", "x**", "", "a-b", "\xc3\xbc"};
+    const char *const values[] = {
+            "next", "prev", "previous", "first", "last", "next last", "NEXT  first", "preload stylesheet", "",
+            "#a", "/ctx", "../ctx", "text/html", "UTF-8''%e2%82%ac", "https://example.com/rel/x", "a b\tc"};
+    const char *const spaces[] = {"", "", "", " ", "\t", "  \t "};
+    const char *const baseUris[] = {
+            "", "https://example.com/a/b?q", "http://x/", "not a uri", "https://example.com/a/b/c/d/"};
+
+    std::string quote(Random &random, const std::string &value) {
+        std::string quoted = "\"";
+        for(char c : value) {
+            if(c == '"' || c == '\\' || random.chance(10))
+                quoted += '\\';
+            quoted += c;
+        }
+        if(random.chance(10))
+            quoted += random.chance(50) ? ",;<>" : "\\";
+        if(random.chance(95))
+            quoted += '"';
+        return quoted;
+    }
+
+    std::string randomHeader(Random &random) {
+        std::string header;
+        std::size_t linkValues = random.below(5);
+        for(std::size_t i = 0; i < linkValues; ++i) {
+            if(i != 0)
+                header += std::string(random.pick(spaces)) + "," + random.pick(spaces);
+            header += "<" + std::string(random.pick(targets)) + (random.chance(97) ? ">" : "");
+            std::size_t parameters = random.below(6);
+            for(std::size_t j = 0; j < parameters; ++j) {
+                header += std::string(random.pick(spaces)) + ";" + random.pick(spaces) + random.pick(names);
+                if(random.chance(85)) {
+                    header += std::string(random.pick(spaces)) + "=" + random.pick(spaces);
+                    std::string value = random.pick(values);
+                    header += random.chance(50) ? quote(random, value) : value.substr(0, value.find_first_of(" \t"));
+                }
+            }
+        }
+        return header;
+    }
+
+    std::string mutate(Random &random, std::string header) {
+        static const char special[] = "<>;,=\"\\ \t*#?&aZ\x7f\x80";
+        std::size_t mutations = 1 + random.below(4);
+        for(std::size_t i = 0; i < mutations; ++i) {
+            std::size_t pos = header.empty() ? 0 : random.below(header.size() + 1);
+            switch(random.below(5)) {
+                case 0:
+                    header.erase(pos, random.below(4));
+                    break;
+                case 1:
+                    header.insert(pos, 1, special[random.below(sizeof(special) - 1)]);
+                    break;
+                case 2:
+                    header.insert(pos, header.substr(random.below(header.size() + 1), random.below(16)));
+                    break;
+                case 3:
+                    if(pos < header.size())
+                        header[pos] = static_cast<char>(header[pos] ^ 0x20);
+                    break;
+                default:
+                    header.resize(pos);
+                    break;
+            }
+        }
+        return header;
+    }
+
+    /**
+     * The inputs of a differential test: randomly generated headers and
+     * mutations of them, with a base URI each.
+     */
+    class Inputs {
+    public:
+        Inputs() : random_(environmentOr("HLH_DIFFERENTIAL_SEED", 8288)),
+                   remaining_(environmentOr("HLH_DIFFERENTIAL_ITERATIONS", 5000)) {}
+
+        bool next() {
+            if(remaining_ == 0)
+                return false;
+            --remaining_;
+            header = randomHeader(random_);
+            if(random_.chance(50))
+                header = mutate(random_, header);
+            baseUri = random_.pick(baseUris);
+            return true;
+        }
+
+        Random& random() {
+            return random_;
+        }
+
+        std::string header;
+        std::string baseUri;
+
+    private:
+        Random random_;
+        unsigned long remaining_;
+    };
+
+    std::string quoted(const std::string &s) {
+        return "\"" + s + "\"";
+    }
+
+    /**
+     * Is id the identifier relationId() gives name? Uninterned identifiers
+     * are all different, so for those only check that name is uninterned too.
+     */
+    bool rightRelationId(const std::string &name, http_link_header::RelationId id) {
+        http_link_header::RelationId expected = http_link_header::relationId(name);
+        return http_link_header::isInterned(id) ? id == expected : !http_link_header::isInterned(expected);
+    }
+
+    /**
+     * Compares links link by link, including the order of their target
+     * attributes, their relation ids and attribute lookups.
+     *
+     * @return a description of the first difference, or an empty string
+     */
+    std::string firstDifference(const std::vector<http_link_header::Link> &expected,
+                                const std::vector<http_link_header::Link> &actual) {
+        std::ostringstream out;
+        if(expected.size() != actual.size()) {
+            out << "expected " << expected.size() << " links, got " << actual.size();
+            return out.str();
+        }
+        for(std::size_t i = 0; i < expected.size(); ++i) {
+            const auto &e = expected[i];
+            const auto &a = actual[i];
+            out << "link " << i << ": ";
+            if(e.linkContext != a.linkContext)
+                out << "linkContext " << quoted(e.linkContext) << " != " << quoted(a.linkContext);
+            else if(e.linkRelation != a.linkRelation)
+                out << "linkRelation " << quoted(e.linkRelation) << " != " << quoted(a.linkRelation);
+            else if(e.linkTarget != a.linkTarget)
+                out << "linkTarget " << quoted(e.linkTarget) << " != " << quoted(a.linkTarget);
+            else if(e.targetAttributes.size() != a.targetAttributes.size())
+                out << e.targetAttributes.size() << " target attributes != " << a.targetAttributes.size();
+            else if(!rightRelationId(e.linkRelation, a.linkRelationId))
+                out << "wrong linkRelationId for " << quoted(e.linkRelation);
+            else {
+                for(std::size_t j = 0; j < e.targetAttributes.size(); ++j) {
+                    const auto &ea = e.targetAttributes[j];
+                    const auto &aa = a.targetAttributes[j];
+                    if(ea.name != aa.name || ea.value != aa.value) {
+                        out << "target attribute " << j << " (" << quoted(ea.name) << ", " << quoted(ea.value)
+                            << ") != (" << quoted(aa.name) << ", " << quoted(aa.value) << ")";
+                        return out.str();
+                    }
+
+                    // attr() finds the first attribute of that name
+                    std::size_t first = 0;
+                    while(e.targetAttributes[first].name != ea.name)
+                        ++first;
+                    if(a.attr(http_link_header::StringView(ea.name)) != &a.targetAttributes[first]) {
+                        out << "attr(" << quoted(ea.name) << ") does not find attribute " << first;
+                        return out.str();
+                    }
+                }
+                out.str("");
+                continue;
+            }
+            return out.str();
+        }
+        return "";
+    }
+
+    std::string printable(const std::string &s) {
+        std::ostringstream out;
+        for(unsigned char c : s) {
+            if(c == '\t')
+                out << "\\t";
+            else if(c < 0x20 || c >= 0x7f)
+                out << "\\x" << std::hex << static_cast<int>(c) << std::dec;
+            else
+                out << c;
+        }
+        return out.str();
+    }
+
+}
+
+TEST_CASE("differential: parse() matches the reference implementation") {
+    Inputs inputs;
+    while(inputs.next()) {
+        std::string difference = firstDifference(reference::parse(inputs.header, inputs.baseUri),
+                                                 http_link_header::parse(inputs.header, inputs.baseUri));
+        if(!difference.empty()) {
+            INFO("header: " << printable(inputs.header) << "\nbase: " << inputs.baseUri);
+            CHECK_MESSAGE(false, difference);
+            break;
+        }
+    }
+}
+
+TEST_CASE("differential: tryParse() reports where the reference implementation stops") {
+    Inputs inputs;
+    while(inputs.next()) {
+        std::size_t stop;
+        auto expected = reference::parse(inputs.header, inputs.baseUri, &stop);
+        auto result = http_link_header::tryParse(inputs.header, inputs.baseUri);
+
+        std::string difference = firstDifference(expected, result.links);
+        http_link_header::ParseError error = http_link_header::ParseError::None;
+        if(stop != inputs.header.size())
+            error = inputs.header[stop] == '<' ? http_link_header::ParseError::UnterminatedTarget
+                                               : http_link_header::ParseError::ExpectedTarget;
+        if(difference.empty() && result.error != error)
+            difference = std::string("error \"") + http_link_header::errorMessage(result.error) + "\" != \"" +
+                         http_link_header::errorMessage(error) + "\"";
+        else if(difference.empty() && result.offset != stop)
+            difference = "offset " + std::to_string(result.offset) + " != " + std::to_string(stop);
+
+        if(!difference.empty()) {
+            INFO("header: " << printable(inputs.header) << "\nbase: " << inputs.baseUri);
+            CHECK_MESSAGE(false, difference);
+            break;
+        }
+    }
+}
+
+TEST_CASE("differential: recovering tryParse() parses what is not skipped like the reference implementation") {
+    http_link_header::ParseOptions options;
+    options.recover = true;
+
+    Inputs inputs;
+    while(inputs.next()) {
+        auto result = http_link_header::tryParse(inputs.header, inputs.baseUri, options);
+
+        // the parts between skipped spans parse completely on their own
+        std::vector<http_link_header::Link> expected;
+        std::string difference;
+        std::size_t from = 0;
+        for(std::size_t i = 0; i <= result.skipped.size() && difference.empty(); ++i) {
+            std::size_t to = i < result.skipped.size() ? result.skipped[i].offset : inputs.header.size();
+            std::size_t stop;
+            auto links = reference::parse(inputs.header.substr(from, to - from), inputs.baseUri, &stop);
+            expected.insert(expected.end(), links.begin(), links.end());
+            if(stop != to - from)
+                difference = "the reference implementation stops at " + std::to_string(from + stop) +
+                             ", not at " + std::to_string(to);
+            if(i < result.skipped.size())
+                from = to + result.skipped[i].size;
+        }
+        if(difference.empty())
+            difference = firstDifference(expected, result.links);
+
+        if(!difference.empty()) {
+            INFO("header: " << printable(inputs.header) << "\nbase: " << inputs.baseUri);
+            CHECK_MESSAGE(false, difference);
+            break;
+        }
+    }
+}
+
+TEST_CASE("differential: tryParse() with a byte budget gives a prefix of the reference links") {
+    Inputs inputs;
+    while(inputs.next()) {
+        std::size_t stop;
+        auto expected = reference::parse(inputs.header, inputs.baseUri, &stop);
+
+        http_link_header::ParseOptions options;
+        options.recover = inputs.random().chance(50);
+        std::size_t bytes = inputs.random().below(inputs.header.size() + 2);
+        options.budget.maxBytes = bytes;
+        auto result = http_link_header::tryParse(inputs.header, inputs.baseUri, options);
+
+        // without recovery the links are a prefix of the reference links;
+        // in recovery mode they are a prefix of all links up to the budget
+        std::string difference;
+        if(result.offset > bytes)
+            difference = "offset " + std::to_string(result.offset) + " is past the budget";
+        else if(!options.recover) {
+            std::size_t count = std::min(result.links.size(), expected.size());
+            expected.resize(count);
+            difference = firstDifference(expected, result.links);
+        }
+        else {
+            options.budget = http_link_header::ParseBudget();
+            auto all = http_link_header::tryParse(inputs.header, inputs.baseUri, options);
+            if(result.links.size() > all.links.size() ||
+               !std::equal(result.links.begin(), result.links.end(), all.links.begin()))
+                difference = "the links are not a prefix of those without a budget";
+        }
+        if(difference.empty() && result.error == http_link_header::ParseError::None && bytes < inputs.header.size())
+            difference = "no error although the budget ends before the header";
+
+        if(!difference.empty()) {
+            INFO("header: " << printable(inputs.header) << "\nbase: " << inputs.baseUri
+                            << "\nbytes: " << bytes);
+            CHECK_MESSAGE(false, difference);
+            break;
+        }
+    }
+}
+
+TEST_CASE("differential: parseGroups() and expand() match the reference implementation") {
+    Inputs inputs;
+    while(inputs.next()) {
+        auto groups = http_link_header::parseGroups(inputs.header, inputs.baseUri);
+        auto expected = reference::parse(inputs.header, inputs.baseUri);
+        std::string difference = firstDifference(expected, http_link_header::expand(groups));
+
+        // LinkGroup::attr() agrees with the attributes of its links
+        for(std::size_t i = 0; difference.empty() && i < groups.size(); ++i) {
+            for(const auto &attribute : groups[i].targetAttributes) {
+                const auto *found = groups[i].attr(attribute.id);
+                if(attribute.id != http_link_header::Param::Unknown && (!found || found->name != attribute.name))
+                    difference = "group " + std::to_string(i) + ": attr() does not find " + quoted(attribute.name);
+            }
+        }
+
+        if(!difference.empty()) {
+            INFO("header: " << printable(inputs.header) << "\nbase: " << inputs.baseUri);
+            CHECK_MESSAGE(false, difference);
+            break;
+        }
+    }
+}
+
+TEST_CASE("differential: parse() of several headers matches the reference implementation") {
+    Inputs inputs;
+    while(inputs.next()) {
+        std::vector<std::string> headers;
+        std::vector<http_link_header::Link> expected;
+        std::size_t count = inputs.random().below(4);
+        for(std::size_t i = 0; i < count && inputs.next(); ++i)
+            headers.push_back(inputs.header);
+
+        // all headers of a set are resolved against the last base URI
+        for(const auto &header : headers) {
+            auto links = reference::parse(header, inputs.baseUri);
+            expected.insert(expected.end(), links.begin(), links.end());
+        }
+
+        std::string difference = firstDifference(expected, http_link_header::parse(headers, inputs.baseUri));
+        if(!difference.empty()) {
+            std::string all;
+            for(const auto &header : headers)
+                all += "\n  " + printable(header);
+            INFO("headers:" << all << "\nbase: " << inputs.baseUri);
+            CHECK_MESSAGE(false, difference);
+            break;
+        }
+    }
+}
+
+TEST_CASE("differential: extract_pagination() matches the reference implementation") {
+    Inputs inputs;
+    while(inputs.next()) {
+        auto links = reference::parse(inputs.header);
+        auto pagination = http_link_header::extract_pagination(inputs.header);
+
+        struct Expected {
+            const char *relation;
+            const char *alias;
+            const http_link_header::PageLink &actual;
+        };
+        const Expected slots[] = {{"first", "first", pagination.first}, {"prev", "previous", pagination.prev},
+                                  {"next", "next", pagination.next}, {"last", "last", pagination.last}};
+
+        std::string difference;
+        for(const auto &slot : slots) {
+            const http_link_header::Link *link = nullptr;
+            for(const auto &l : links) {
+                if(l.linkRelation == slot.relation || l.linkRelation == slot.alias) {
+                    link = &l;
+                    break;
+                }
+            }
+            if(!link != !slot.actual.found)
+                difference = std::string(slot.relation) + (link ? " not found" : " found");
+            else if(link && slot.actual.target.str() != link->linkTarget)
+                difference = std::string(slot.relation) + " target " + quoted(link->linkTarget) + " != " +
+                             quoted(slot.actual.target.str());
+            if(!difference.empty())
+                break;
+        }
+
+        if(!difference.empty()) {
+            INFO("header: " << printable(inputs.header));
+            CHECK_MESSAGE(false, difference);
+            break;
+        }
+    }
+}
+
+TEST_CASE("relation types seen once the table is full are compared by name") {
+    // fill the table, in case the random relation types above have not
+    for(int i = 0; i < HLH_RELATION_INTERN_LIMIT; ++i)
+        http_link_header::relationId("http://example.net/fill-" + std::to_string(i));
+
+    auto a = http_link_header::parse(R"(</a>; rel="http://example.net/late")");
+    auto b = http_link_header::parse(R"(</b>; rel="HTTP://EXAMPLE.NET/late http://example.net/later")");
+
+    REQUIRE(a.size() == 1);
+    REQUIRE(b.size() == 2);
+    CHECK(!http_link_header::isInterned(a[0].linkRelationId));
+    CHECK(a[0].linkRelationId != b[0].linkRelationId);
+    CHECK(a[0].linkRelationId != static_cast<http_link_header::RelationId>(http_link_header::Relation::Extension));
+    CHECK(http_link_header::relationName(a[0].linkRelationId).empty());
+    CHECK(a[0].sameRelation(b[0]));
+    CHECK(!a[0].sameRelation(b[1]));
+
+    // relation types seen before keep their identifiers; the random ones
+    // above may have been interned before the ones of the loop
+    http_link_header::RelationId first =
+            static_cast<http_link_header::RelationId>(http_link_header::Relation::Extension) + 1;
+    std::string name = http_link_header::relationName(first).str();
+    std::string upper = name;
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](char c) {
+        return c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c;
+    });
+    CHECK(!name.empty());
+    CHECK(http_link_header::relationId(name) == first);
+    CHECK(http_link_header::relationId(upper) == first);
+    CHECK(http_link_header::parse("</c>; rel=NEXT")[0].hasRelation(http_link_header::Relation::Next));
+}
@@ -0,0 +1,355 @@
+// This file contains tests for the error reporting of tryParse() and
+// tryParseGroups(). It is also built with -fno-exceptions into the
+// no_exceptions_tests executable, see CMakeLists.txt.
+
+#include "http-link-header.h"
+#include "doctest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <string>
+#include <utility>
+
+static_assert(noexcept(http_link_header::tryParse(std::declval<const std::string&>(),
+                                                 std::declval<const std::string&>())),
+              "tryParse() must not throw");
+static_assert(noexcept(http_link_header::tryParseGroups(std::declval<const std::string&>(),
+                                                       std::declval<const std::string&>())),
+              "tryParseGroups() must not throw");
+static_assert(noexcept(http_link_header::extract_pagination(std::declval<http_link_header::StringView>())),
+              "extract_pagination() must not throw");
+
+TEST_CASE("tryParse of a well-formed header reports no error") {
+    std::string header = R"(<https://example.com/TheBook/chapter2>; rel="previous"; title="previous chapter", )"
+                         R"(<https://example.com/TheBook/chapter4>; rel="next")";
+    auto result = http_link_header::tryParse(header, "https://example.org/");
+
+    CHECK(result.ok());
+    CHECK(result.error == http_link_header::ParseError::None);
+    CHECK(result.offset == header.size());
+    CHECK(result.links == http_link_header::parse(header, "https://example.org/"));
+}
+
+TEST_CASE("tryParse of an empty or blank header reports no error") {
+    CHECK(http_link_header::tryParse("").ok());
+    CHECK(http_link_header::tryParse("").offset == 0);
+    CHECK(http_link_header::tryParse(" \t ").ok());
+    CHECK(http_link_header::tryParse(" \t ").offset == 3);
+    CHECK(http_link_header::tryParse("</a>; rel=next,  ").ok());
+}
+
+TEST_CASE("tryParse reports a link-value that does not start with <") {
+    std::string header = R"(</a>; rel=next, https://example.com/b; rel=prev)";
+    auto result = http_link_header::tryParse(header);
+
+    CHECK(result.error == http_link_header::ParseError::ExpectedTarget);
+    CHECK(result.offset == header.find("https"));
+    CHECK(result.links.size() == 1);
+    CHECK((!result.links.empty() && result.links[0].linkTarget == "/a"));
+}
+
+TEST_CASE("tryParse accepts link-values without parameters") {
+    // step 2.2 of Appendix B.3 returns before the comma if there are no
+    // parameters, which must not make the next link-value start with ","
+    auto result = http_link_header::tryParse("</a>, </b>");
+
+    CHECK(result.ok());
+    CHECK(result.offset == 10);
+    CHECK(result.links.size() == 2);
+    if(result.links.size() == 2) {
+        CHECK(result.links[0].linkTarget == "/a");
+        CHECK(result.links[1].linkTarget == "/b");
+    }
+}
+
+TEST_CASE("tryParse reports a target without >") {
+    std::string header = R"(</a>; rel=next,  </b; rel=prev)";
+    auto result = http_link_header::tryParse(header);
+
+    CHECK(result.error == http_link_header::ParseError::UnterminatedTarget);
+    CHECK(result.offset == header.find("</b"));
+    CHECK(result.links.size() == 1);
+}
+
+TEST_CASE("tryParseGroups reports errors like tryParse") {
+    std::string header = R"(</a>; rel="next last", </b; rel=prev)";
+    auto groups = http_link_header::tryParseGroups(header);
+    auto links = http_link_header::tryParse(header);
+
+    CHECK(groups.error == http_link_header::ParseError::UnterminatedTarget);
+    CHECK(groups.offset == links.offset);
+    CHECK(groups.groups.size() == 1);
+    CHECK(http_link_header::expand(groups.groups) == links.links);
+}
+
+TEST_CASE("every parse error has a message") {
+    using http_link_header::ParseError;
+    const std::string unknown = http_link_header::errorMessage(static_cast<ParseError>(255));
+
+    // Cancelled is the last enumerator; once there is a message after it,
+    // this loop must go further
+    const int last = static_cast<int>(ParseError::Cancelled);
+    std::set<std::string> messages;
+    for(int value = 0; value <= last; ++value) {
+        std::string message = http_link_header::errorMessage(static_cast<ParseError>(value));
+        INFO("ParseError " << value);
+        CHECK(!message.empty());
+        CHECK(message != unknown);
+        CHECK(messages.insert(message).second);
+    }
+    CHECK(http_link_header::errorMessage(static_cast<ParseError>(last + 1)) == unknown);
+}
+
+namespace {
+
+    http_link_header::ParseOptions recovering() {
+        http_link_header::ParseOptions options;
+        options.recover = true;
+        return options;
+    }
+
+}
+
+TEST_CASE("recovery mode skips link-values that do not start with <") {
+    std::string header = R"(</a>; rel=next, https://example.com/b; rel=prev, </c>; rel=last)";
+    auto result = http_link_header::tryParse(header, "", recovering());
+
+    CHECK_FALSE(result.ok());
+    CHECK(result.error == http_link_header::ParseError::None);
+    CHECK(result.offset == header.size());
+    CHECK(result.links.size() == 2);
+    CHECK(result.links.back().linkTarget == "/c");
+
+    CHECK(result.skipped.size() == 1);
+    if(!result.skipped.empty()) {
+        CHECK(result.skipped[0].error == http_link_header::ParseError::ExpectedTarget);
+        CHECK(header.substr(result.skipped[0].offset, result.skipped[0].size) == "https://example.com/b; rel=prev,");
+    }
+}
+
+TEST_CASE("recovery mode does not resynchronize at commas in quoted strings or targets") {
+    std::string header = R"(</a>; rel=next; x y <c,d>; title="a, b", </f>; rel=last)";
+    auto result = http_link_header::tryParse(header, "", recovering());
+
+    CHECK(result.links.size() == 2);
+    CHECK(result.skipped.size() == 1);
+    if(!result.skipped.empty())
+        CHECK(header.substr(result.skipped[0].offset, result.skipped[0].size) == R"(y <c,d>; title="a, b",)");
+}
+
+TEST_CASE("recovery mode skips the rest of the header after a target without >") {
+    std::string header = R"(</a>; rel=next, <b; rel=prev, <c; rel=last)";
+    auto result = http_link_header::tryParse(header, "", recovering());
+
+    CHECK(result.links.size() == 1);
+    CHECK(result.skipped.size() == 1);
+    if(!result.skipped.empty()) {
+        CHECK(result.skipped[0].error == http_link_header::ParseError::UnterminatedTarget);
+        CHECK(result.skipped[0].offset + result.skipped[0].size == header.size());
+    }
+}
+
+TEST_CASE("recovery mode skips nothing in link-values without parameters") {
+    auto result = http_link_header::tryParse("</a>, </b>", "", recovering());
+
+    CHECK(result.ok());
+    CHECK(result.links.size() == 2);
+    CHECK(result.skipped.empty());
+}
+
+TEST_CASE("recovery mode skips an empty link-value after one without parameters") {
+    auto result = http_link_header::tryParse("</a>, , </c>", "", recovering());
+
+    CHECK(result.links.size() == 2);
+    CHECK(result.skipped.size() == 1);
+    if(!result.skipped.empty()) {
+        CHECK(result.skipped[0].offset == 6);
+        CHECK(result.skipped[0].size == 1);
+    }
+}
+
+TEST_CASE("tryParseGroups recovers like tryParse") {
+    std::string header = R"(x, </a>; rel="next last", ; y, </b>; rel=prev, "z")";
+    auto groups = http_link_header::tryParseGroups(header, "", recovering());
+    auto links = http_link_header::tryParse(header, "", recovering());
+
+    CHECK(groups.groups.size() == 2);
+    CHECK(http_link_header::expand(groups.groups) == links.links);
+    CHECK(groups.skipped.size() == 3);
+    CHECK(groups.skipped.size() == links.skipped.size());
+}
+
+namespace {
+
+    http_link_header::ParseOptions limited(std::size_t http_link_header::ParseLimits::*limit, std::size_t value) {
+        http_link_header::ParseOptions options;
+        options.limits.*limit = value;
+        return options;
+    }
+
+}
+
+TEST_CASE("parsing within limits reports no error") {
+    using http_link_header::ParseLimits;
+    std::string header = R"(</a>; rel="next last"; title="x", </b>; rel=prev)";
+
+    CHECK(http_link_header::tryParse(header, "", limited(&ParseLimits::maxHeaderBytes, header.size())).ok());
+    CHECK(http_link_header::tryParse(header, "", limited(&ParseLimits::maxLinks, 3)).ok());
+    CHECK(http_link_header::tryParse(header, "", limited(&ParseLimits::maxParametersPerLink, 2)).ok());
+    CHECK(http_link_header::tryParse(header, "", limited(&ParseLimits::maxRelationsPerLink, 2)).ok());
+    CHECK(http_link_header::tryParse(header, "", limited(&ParseLimits::maxQuotedStringLength, 9)).ok());
+    CHECK(http_link_header::tryParse(header, "", limited(&ParseLimits::maxResolvedUriLength, 2)).ok());
+}
+
+TEST_CASE("exceeding a limit stops parsing at the link-value with a distinct error") {
+    using http_link_header::ParseError;
+    using http_link_header::ParseLimits;
+    std::string header = R"(</a>; rel=next, </bb>; rel="prev first"; title="x"; type=t, </c>; rel=last)";
+    std::size_t second = header.find("</bb>") - 1;
+
+    struct Case {
+        std::size_t ParseLimits::*limit;
+        std::size_t value;
+        ParseError error;
+        std::size_t offset;
+        std::size_t links;
+    };
+    const Case cases[] = {
+            {&ParseLimits::maxHeaderBytes, header.size() - 1, ParseError::HeaderTooLarge, 0, 0},
+            {&ParseLimits::maxLinks, 2, ParseError::TooManyLinks, second, 1},
+            {&ParseLimits::maxParametersPerLink, 2, ParseError::TooManyParameters, second, 1},
+            {&ParseLimits::maxRelationsPerLink, 1, ParseError::TooManyRelations, second, 1},
+            {&ParseLimits::maxQuotedStringLength, 5, ParseError::QuotedStringTooLong, second, 1},
+            {&ParseLimits::maxResolvedUriLength, 2, ParseError::UriTooLong, second, 1}};
+
+    for(const auto &c : cases) {
+        auto options = limited(c.limit, c.value);
+        auto result = http_link_header::tryParse(header, "", options);
+        auto groups = http_link_header::tryParseGroups(header, "", options);
+        INFO(http_link_header::errorMessage(c.error));
+
+        CHECK(result.error == c.error);
+        CHECK(result.offset == c.offset);
+        CHECK(result.links.size() == c.links);
+        CHECK(groups.error == c.error);
+        CHECK(groups.offset == c.offset);
+
+        // limits stop parsing in recovery mode too
+        options.recover = true;
+        CHECK(http_link_header::tryParse(header, "", options).error == c.error);
+    }
+}
+
+TEST_CASE("the resolved URI limit applies to the context too") {
+    http_link_header::ParseOptions options;
+    options.limits.maxResolvedUriLength = 24;
+    auto result =
+            http_link_header::tryParse(R"(</a>; anchor="#a-very-long-fragment")", "https://example.org/", options);
+
+    CHECK(result.error == http_link_header::ParseError::UriTooLong);
+    CHECK(result.links.empty());
+}
+
+TEST_CASE("a byte budget stops parsing at the first link-value that does not fit") {
+    std::string header = R"(</a>; rel=next, </b>; rel=prev, </c>; rel=last)";
+    std::size_t second = header.find(',') + 1;
+    http_link_header::ParseOptions options;
+
+    options.budget.maxBytes = header.size();
+    CHECK(http_link_header::tryParse(header, "", options).ok());
+
+    // the link-value might go on after the last byte of the budget
+    options.budget.maxBytes = second;
+    CHECK(http_link_header::tryParse(header, "", options).links.empty());
+
+    options.budget.maxBytes = second + 1;
+    auto result = http_link_header::tryParse(header, "", options);
+    CHECK(result.error == http_link_header::ParseError::BudgetExhausted);
+    CHECK(result.offset == second);
+    CHECK(result.links.size() == 1);
+
+    // "rel=nex" might continue, so the link-value is not parsed
+    options.budget.maxBytes = header.size() - 1;
+    result = http_link_header::tryParse(header, "", options);
+    CHECK(result.error == http_link_header::ParseError::BudgetExhausted);
+    CHECK(result.offset == header.rfind(',') + 1);
+    CHECK(result.links.size() == 2);
+}
+
+TEST_CASE("every byte budget gives a prefix of the links") {
+    std::string header = R"(<a>; rel="next last"; title="t, u", <b> ; rel=prev ,<c>,<d>;x;anchor=#y)";
+    auto all = http_link_header::tryParse(header, "https://example.org/");
+
+    http_link_header::ParseOptions options;
+    for(std::size_t bytes = 0; bytes <= header.size(); ++bytes) {
+        options.budget.maxBytes = bytes;
+        auto result = http_link_header::tryParse(header, "https://example.org/", options);
+        INFO("bytes: " << bytes);
+
+        CHECK(result.links.size() <= all.links.size());
+        CHECK(std::equal(result.links.begin(), result.links.end(), all.links.begin()));
+        CHECK(result.offset <= bytes);
+        if(result.error != all.error)
+            CHECK(result.error == http_link_header::ParseError::BudgetExhausted);
+    }
+}
+
+TEST_CASE("a resolution budget allows two resolutions per link-value") {
+    std::string header = R"(</a>; rel=next, </b>; rel=prev)";
+    http_link_header::ParseOptions options;
+
+    options.budget.maxResolutions = 3;
+    auto result = http_link_header::tryParse(header, "https://example.org/", options);
+    CHECK(result.error == http_link_header::ParseError::BudgetExhausted);
+    CHECK(result.links.size() == 1);
+
+    options.budget.maxResolutions = 4;
+    CHECK(http_link_header::tryParse(header, "https://example.org/", options).ok());
+}
+
+TEST_CASE("a deadline stops parsing before the next link-value") {
+    std::string header = R"(</a>; rel=next, </b>; rel=prev)";
+    http_link_header::ParseOptions options;
+
+    options.budget.deadline = std::chrono::steady_clock::now() - std::chrono::seconds(1);
+    auto result = http_link_header::tryParseGroups(header, "", options);
+    CHECK(result.error == http_link_header::ParseError::BudgetExhausted);
+    CHECK(result.offset == 0);
+    CHECK(result.groups.empty());
+
+    options.budget.deadline = std::chrono::steady_clock::now() + std::chrono::hours(1);
+    CHECK(http_link_header::tryParseGroups(header, "", options).ok());
+}
+
+TEST_CASE("recovery mode stops when the budget ends before the next comma") {
+    std::string header = R"(</a>; rel=next, x; rel=prev, </c>)";
+    http_link_header::ParseOptions options;
+    options.recover = true;
+    options.budget.maxBytes = header.find("prev");
+    auto result = http_link_header::tryParse(header, "", options);
+
+    CHECK(result.error == http_link_header::ParseError::BudgetExhausted);
+    CHECK(result.offset == header.find(", x") + 2);
+    CHECK(result.links.size() == 1);
+    CHECK(result.skipped.empty());
+}
+
+TEST_CASE("a cancelled parse stops before the next link-value") {
+    std::string header = R"(</a>; rel=next, </b>; rel=prev)";
+    std::atomic<bool> cancelled(false);
+    http_link_header::ParseOptions options;
+    options.cancelled = &cancelled;
+
+    CHECK(http_link_header::tryParse(header, "", options).ok());
+
+    cancelled = true;
+    auto result = http_link_header::tryParseGroups(header, "", options);
+    CHECK(result.error == http_link_header::ParseError::Cancelled);
+    CHECK(result.offset == 0);
+    CHECK(result.groups.empty());
+
+    // an empty field value has no link-value to stop before
+    CHECK(http_link_header::tryParse("", "", options).ok());
+}
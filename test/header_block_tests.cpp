@@ -0,0 +1,79 @@
+// This file contains tests for parse_from_header_block()
+
+#include "http-link-header.h"
+#include "doctest.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+    std::vector<http_link_header::Link> parseBlock(const std::string &block, const std::string &baseUri = "") {
+        return http_link_header::parse_from_header_block(block.data(), block.size(), baseUri);
+    }
+
+}
+
+TEST_CASE("parse_from_header_block parses every Link header field") {
+    std::string block = "HTTP/1.1 200 OK\r\n"
+                        "Content-Type: text/html\r\n"
+                        "Link: </a>; rel=next\r\n"
+                        "X-Link: </x>; rel=ignored\r\n"
+                        "link:</b>; rel=\"prev first\", </c>; rel=last  \r\n"
+                        "Linked: </y>; rel=ignored\r\n"
+                        "LINK: <d>; anchor=\"#e\"\r\n"
+                        "\r\n"
+                        "Link: </body>; rel=ignored\r\n";
+
+    auto links = parseBlock(block, "https://example.com/f/");
+    auto expected = http_link_header::parse(std::vector<std::string>{
+            " </a>; rel=next", "</b>; rel=\"prev first\", </c>; rel=last  ", " <d>; anchor=\"#e\""},
+            "https://example.com/f/");
+
+    REQUIRE(links.size() == 5);
+    CHECK(links == expected);
+    CHECK(links[4].linkTarget == "https://example.com/f/d");
+}
+
+TEST_CASE("parse_from_header_block joins folded field values") {
+    std::string block = "Link: </a>;\r\n"
+                        "  rel=\"next\r\n"
+                        "\tlast\",\r\n"
+                        " </b>; rel=prev\r\n"
+                        "Content-Length: 0\r\n";
+
+    auto links = parseBlock(block);
+    REQUIRE(links.size() == 3);
+    CHECK(links[0].linkRelation == "next");
+    CHECK(links[1].linkRelation == "last");
+    CHECK(links[2].linkTarget == "/b");
+    CHECK(links[2].linkRelation == "prev");
+}
+
+TEST_CASE("parse_from_header_block accepts bare LF and a missing last line break") {
+    std::string block = "Server: x\nLink: </a>; rel=next\nLink: </b>; rel=prev";
+    auto links = parseBlock(block);
+
+    REQUIRE(links.size() == 2);
+    CHECK(links[0].linkTarget == "/a");
+    CHECK(links[1].linkTarget == "/b");
+}
+
+TEST_CASE("parse_from_header_block ignores what is not a Link header field") {
+    CHECK(parseBlock("").empty());
+    CHECK(parseBlock("\r\nLink: </a>\r\n").empty());
+    CHECK(parseBlock("Link : </a>\r\n").empty());
+    CHECK(parseBlock(" Link: </a>\r\n").empty());
+    CHECK(parseBlock("Link\r\n:</a>\r\n").empty());
+    CHECK(parseBlock("Content-Type: text/html\r\n </a>; rel=next\r\n").empty());
+}
+
+TEST_CASE("parse_from_header_block stops at a malformed link-value within its field only") {
+    std::string block = "Link: </a>; rel=next, oops, </b>\r\n"
+                        "Link: </c>; rel=last\r\n";
+    auto links = parseBlock(block);
+
+    REQUIRE(links.size() == 2);
+    CHECK(links[0].linkTarget == "/a");
+    CHECK(links[1].linkTarget == "/c");
+}
@@ -0,0 +1,115 @@
+// This file contains tests for extract_pagination()
+
+#include "http-link-header.h"
+#include "doctest.h"
+
+
+static std::string header_github = // NOLINT(cert-err58-cpp)
+        R"(<https://api.github.com/repositories/1300192/issues?page=2>; rel="prev", )"
+        R"(<https://api.github.com/repositories/1300192/issues?page=4>; rel="next", )"
+        R"(<https://api.github.com/repositories/1300192/issues?page=515>; rel="last", )"
+        R"(<https://api.github.com/repositories/1300192/issues?page=1>; rel="first")";
+
+TEST_CASE("pagination, empty header") {
+    auto pagination = http_link_header::extract_pagination("");
+
+    CHECK_FALSE(pagination.first.found);
+    CHECK_FALSE(pagination.prev.found);
+    CHECK_FALSE(pagination.next.found);
+    CHECK_FALSE(pagination.last.found);
+}
+
+TEST_CASE("pagination, github style header") {
+    auto pagination = http_link_header::extract_pagination(header_github);
+
+    CHECK(pagination.first.found);
+    CHECK(pagination.first.target == "https://api.github.com/repositories/1300192/issues?page=1");
+    CHECK(pagination.first.page == 1);
+
+    CHECK(pagination.prev.found);
+    CHECK(pagination.prev.page == 2);
+
+    CHECK(pagination.next.found);
+    CHECK(pagination.next.target == "https://api.github.com/repositories/1300192/issues?page=4");
+    CHECK(pagination.next.page == 4);
+
+    CHECK(pagination.last.found);
+    CHECK(pagination.last.page == 515);
+    CHECK(pagination.last.cursor.empty());
+}
+
+TEST_CASE("pagination, views point into the header") {
+    auto pagination = http_link_header::extract_pagination(header_github);
+
+    CHECK(pagination.next.target.data() > header_github.data());
+    CHECK(pagination.next.target.end() < header_github.data() + header_github.size());
+}
+
+TEST_CASE("pagination, cursor parameter") {
+    auto pagination = http_link_header::extract_pagination(
+            R"(<https://example.com/items?cursor=abc%3D&limit=10#top>; rel=next)");
+
+    CHECK(pagination.next.found);
+    CHECK(pagination.next.cursor == "abc%3D");
+    CHECK(pagination.next.page == -1);
+}
+
+TEST_CASE("pagination, non-numeric page parameter") {
+    auto pagination = http_link_header::extract_pagination(R"(</items?page=two>; rel="next")");
+
+    CHECK(pagination.next.found);
+    CHECK(pagination.next.page == -1);
+}
+
+TEST_CASE("pagination, over-long page parameter") {
+    auto pagination = http_link_header::extract_pagination(
+            R"(</items?page=999999999999999999>; rel="first", </items?page=99999999999999999999>; rel="next")");
+
+    CHECK(pagination.first.page == 999999999999999999LL);
+    CHECK(pagination.next.found);
+    CHECK(pagination.next.page == -1);
+}
+
+TEST_CASE("pagination, only the first page and cursor parameters count") {
+    auto pagination = http_link_header::extract_pagination(
+            R"(</items?page=abc&page=5&cursor=a&cursor=b>; rel="next", )"
+            R"(</items?page&page=2&cursor&cursor=c>; rel="last")");
+
+    CHECK(pagination.next.page == -1);
+    CHECK(pagination.next.cursor == "a");
+    CHECK(pagination.last.page == -1);
+    CHECK(pagination.last.found);
+    CHECK(pagination.last.cursor.data());
+    CHECK(pagination.last.cursor.empty());
+}
+
+TEST_CASE("pagination, relation types are matched case-insensitively among others") {
+    auto pagination = http_link_header::extract_pagination(
+            R"(</a>; rel="alternate PREVIOUS", </b>; title="x"; rel="Next last")");
+
+    CHECK(pagination.prev.found);
+    CHECK(pagination.prev.target == "/a");
+    CHECK(pagination.next.target == "/b");
+    CHECK(pagination.last.target == "/b");
+    CHECK_FALSE(pagination.first.found);
+}
+
+TEST_CASE("pagination, first link with a relation type wins") {
+    auto pagination = http_link_header::extract_pagination(R"(</a>; rel="next", </b>; rel="next")");
+
+    CHECK(pagination.next.target == "/a");
+}
+
+TEST_CASE("pagination, stops at malformed link-value") {
+    auto pagination = http_link_header::extract_pagination(R"(</a>; rel="prev", /b; rel="next")");
+
+    CHECK(pagination.prev.found);
+    CHECK_FALSE(pagination.next.found);
+}
+
+TEST_CASE("pagination, escaped whitespace separates relation types") {
+    auto pagination = http_link_header::extract_pagination(R"(</a>; rel="n\ext\ last")");
+
+    CHECK(pagination.next.target == "/a");
+    CHECK(pagination.last.target == "/a");
+}
@@ -0,0 +1,173 @@
+// This file contains tests for the BoundedQueue and the Pipeline built on it
+
+#include "http-link-header-parallel.h"
+#include "doctest.h"
+
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    /** lines with and without a base URI, some of them malformed */
+    std::string input(int lines) {
+        const char *const headers[] = {
+                R"(</a>; rel=next)",
+                R"(<https://example.com/b>; rel="prev first"; title="a, <b>")",
+                R"(</c>;	rel=last)",
+                R"(oops)",
+                R"(</d>; anchor="#e"; rel=up)"};
+        std::string text;
+        for(int i = 0; i < lines; ++i) {
+            if(i % 3 == 0)
+                text += "https://example.org/" + std::to_string(i % 7) + "/x\t";
+            text += headers[i % 5];
+            text += i % 4 == 0 ? "\r\n" : "\n";
+        }
+        return text;
+    }
+
+}
+
+TEST_CASE("a BoundedQueue holds a power of two values in order") {
+    http_link_header::BoundedQueue<int> queue(5);
+    CHECK(queue.capacity() == 8);
+
+    int value = 0;
+    CHECK_FALSE(queue.tryPop(value));
+    for(int round = 0; round < 3; ++round) {
+        for(int i = 0; i < 8; ++i)
+            CHECK(queue.tryPush(i));
+        CHECK_FALSE(queue.tryPush(8));
+        for(int i = 0; i < 8; ++i) {
+            CHECK(queue.tryPop(value));
+            CHECK(value == i);
+        }
+        CHECK_FALSE(queue.tryPop(value));
+    }
+}
+
+TEST_CASE("a BoundedQueue passes every value once between many threads") {
+    const int producers = 4;
+    const int consumers = 4;
+    const int values = 50000;
+    http_link_header::BoundedQueue<int> queue(64);
+    std::vector<std::atomic<int>> seen(producers * values);
+    for(auto &s : seen)
+        s.store(0);
+    std::atomic<int> popped(0);
+
+    std::vector<std::thread> threads;
+    for(int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            for(int i = 0; i < values; ++i) {
+                while(!queue.tryPush(p * values + i))
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for(int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            int value;
+            while(popped.load() < producers * values) {
+                if(queue.tryPop(value)) {
+                    ++seen[static_cast<std::size_t>(value)];
+                    ++popped;
+                }
+                else
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for(auto &thread : threads)
+        thread.join();
+
+    int wrong = 0;
+    for(auto &s : seen)
+        wrong += s.load() != 1;
+    CHECK(wrong == 0);
+}
+
+TEST_CASE("a Pipeline gives the results of tryParse in the order of the input") {
+    std::string text = input(3000);
+    http_link_header::PipelineOptions options;
+    options.workers = 3;
+    options.capacity = 16;
+    options.parse.recover = true;
+    http_link_header::Pipeline pipeline(options);
+
+    for(int run = 0; run < 2; ++run) {
+        std::istringstream stream(text);
+        std::uint64_t next = 0;
+        int mismatches = 0;
+        pipeline.run(stream, [&](http_link_header::PipelineRecord &record) {
+            mismatches += record.sequence != next++;
+            auto expected = http_link_header::tryParse(record.header.str(), record.baseUri.str(), options.parse);
+            mismatches += record.result.links != expected.links || record.result.error != expected.error ||
+                          record.result.skipped.size() != expected.skipped.size();
+        });
+
+        CHECK(next == 3000);
+        CHECK(mismatches == 0);
+        auto stats = pipeline.stats();
+        CHECK(stats.read.items == 3000);
+        CHECK(stats.parse.items == 3000);
+        CHECK(stats.sink.items == 3000);
+        CHECK(stats.bytes == text.size());
+        CHECK(stats.seconds > 0);
+    }
+}
+
+TEST_CASE("a Pipeline splits the base URI from the header field") {
+    std::istringstream stream("https://example.org/a/\t</b>; rel=next\n</c>;\trel=prev\r\n\n");
+    http_link_header::Pipeline pipeline;
+    std::vector<std::string> targets;
+    pipeline.run(stream, [&](http_link_header::PipelineRecord &record) {
+        targets.push_back(record.result.links.empty() ? "" : record.result.links[0].linkTarget);
+    });
+
+    REQUIRE(targets.size() == 3);
+    CHECK(targets[0] == "https://example.org/b");
+    CHECK(targets[1] == "/c");
+    CHECK(targets[2] == "");
+}
+
+TEST_CASE("a Pipeline passes every result to an unordered sink once") {
+    std::string text = input(2000);
+    http_link_header::PipelineOptions options;
+    options.workers = 4;
+    options.capacity = 8;
+    options.ordered = false;
+    http_link_header::Pipeline pipeline(options);
+
+    std::istringstream stream(text);
+    std::vector<int> seen(2000, 0);
+    pipeline.run(stream, [&](http_link_header::PipelineRecord &record) { ++seen[record.sequence]; });
+
+    int wrong = 0;
+    for(int s : seen)
+        wrong += s != 1;
+    CHECK(wrong == 0);
+}
+
+TEST_CASE("a Pipeline stops when the sink throws and can run again") {
+    std::string text = input(1000);
+    http_link_header::PipelineOptions options;
+    options.workers = 2;
+    options.capacity = 4;
+    http_link_header::Pipeline pipeline(options);
+
+    std::istringstream first(text);
+    CHECK_THROWS_AS(pipeline.run(first, [](http_link_header::PipelineRecord &record) {
+        if(record.sequence == 100)
+            throw std::runtime_error("sink failed");
+    }), std::runtime_error);
+
+    std::istringstream second(text);
+    std::size_t count = 0;
+    pipeline.run(second, [&](http_link_header::PipelineRecord &) { ++count; });
+    CHECK(count == 1000);
+}
@@ -72,3 +72,47 @@ TEST_CASE("readme, ex 4") {
     CHECK(links[1].linkTarget == "https://example.org/a/other");
 
 }
+
+TEST_CASE("readme, ex 5") {
+    std::string header = R"(<https://api.example.com/items?page=2>; rel="next", <https://api.example.com/items?page=9>; rel="last")";
+    auto pagination = http_link_header::extract_pagination(header);
+
+    CHECK(pagination.next.found);
+    CHECK(pagination.next.target.str() == "https://api.example.com/items?page=2");
+    CHECK(pagination.next.page == 2);
+    CHECK(pagination.last.page == 9);
+    CHECK_FALSE(pagination.prev.found);
+}
+
+TEST_CASE("readme, ex 6") {
+    auto groups = http_link_header::parseGroups(R"(<style.css>; rel="preload stylesheet"; as=style)", "https://example.org/");
+
+    CHECK(groups.size() == 1);
+    CHECK(groups[0].linkTarget == "https://example.org/style.css");
+    CHECK(groups[0].linkRelations[0] == "preload");
+    CHECK(groups[0].linkRelations[1] == "stylesheet");
+
+    CHECK(http_link_header::expand(groups).size() == 2);
+}
+
+TEST_CASE("readme, ex 7") {
+    std::string header = R"(<https://example.com/a>; rel="next", https://example.com/b; rel="last")";
+    auto result = http_link_header::tryParse(header);
+
+    CHECK_FALSE(result.ok());
+    CHECK(result.links.size() == 1);
+    CHECK(std::string(http_link_header::errorMessage(result.error)) == R"(expected "<" at the start of a link-value)");
+    CHECK(result.offset == 37);
+}
+
+TEST_CASE("readme, ex 8") {
+    std::string header = R"(<https://example.com/a>; rel="next", https://example.com/b; rel="last", <https://example.com/c>; rel="prev")";
+    http_link_header::ParseOptions options;
+    options.recover = true;
+    auto result = http_link_header::tryParse(header, "", options);
+
+    CHECK(result.links.size() == 2);
+    REQUIRE(result.skipped.size() == 1);
+    CHECK(result.skipped[0].offset == 37);
+    CHECK(header.substr(result.skipped[0].offset, result.skipped[0].size) == R"(https://example.com/b; rel="last",)");
+}
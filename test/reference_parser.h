@@ -0,0 +1,335 @@
+// A straightforward implementation of the parsing algorithm of RFC 8288
+// Appendix B, used as the reference that the optimized parse paths of
+// http-link-header.h are checked against
+//
+// It follows the steps of the appendix one by one on std::string, with no
+// views, bitmasks, indexes or grouping, and favours being obviously right
+// over being fast.
+
+#ifndef HLH_TEST_REFERENCE_PARSER_H
+#define HLH_TEST_REFERENCE_PARSER_H
+
+#include "http-link-header.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace reference {
+
+    inline bool isOws(char c) {
+        return c == ' ' || c == '\t';
+    }
+
+    inline void skipOws(const std::string &input, std::size_t &pos) {
+        while(pos < input.size() && isOws(input[pos]))
+            ++pos;
+    }
+
+    inline std::string lowercase(std::string s) {
+        for(auto &c : s) {
+            if(c >= 'A' && c <= 'Z')
+                c = static_cast<char>(c - 'A' + 'a');
+        }
+        return s;
+    }
+
+    /**
+     * Appendix B.4, consuming input from pos.
+     */
+    inline std::string parseQuotedString(const std::string &input, std::size_t &pos) {
+
+        // 1. Let output be an empty string.
+        std::string output;
+
+        // 2. If the first character of input is not DQUOTE, return output.
+        if(pos >= input.size() || input[pos] != '"')
+            return output;
+
+        // 3. Discard the first character.
+        ++pos;
+
+        // 4. While input has content:
+        while(pos < input.size()) {
+            // 4.1. If the first character is a backslash ("\"):
+            if(input[pos] == '\\') {
+                // 4.1.1. Discard the first character.
+                ++pos;
+                // 4.1.2. If there is no more input, return output.
+                if(pos >= input.size())
+                    return output;
+                // 4.1.3. Else, consume the first character and append it to output.
+                output.push_back(input[pos++]);
+            }
+            // 4.2. Else, if the first character is DQUOTE, discard it and return output.
+            else if(input[pos] == '"') {
+                ++pos;
+                return output;
+            }
+            // 4.3. Else, consume the first character and append it to output.
+            else
+                output.push_back(input[pos++]);
+        }
+
+        // 5. Return output.
+        return output;
+    }
+
+    /**
+     * Appendix B.3, consuming input from pos.
+     */
+    inline std::vector<http_link_header::TargetAttribute> parseParameters(const std::string &input, std::size_t &pos) {
+
+        // 1. Let parameters be an empty list.
+        std::vector<http_link_header::TargetAttribute> parameters;
+
+        // 2. While input has content:
+        while(pos < input.size()) {
+            // 2.1. Consume any leading OWS.
+            skipOws(input, pos);
+
+            // 2.2. If the first character is not ";", return parameters.
+            if(pos >= input.size() || input[pos] != ';')
+                return parameters;
+
+            // 2.3. Discard the leading ";" character.
+            ++pos;
+
+            // 2.4. Consume any leading OWS.
+            skipOws(input, pos);
+
+            // 2.5. Consume up to but not including the first BWS, "=", ";", or
+            //      "," character, or up to the end of input, and let the
+            //      result be parameter_name.
+            std::size_t end = input.find_first_of(" \t=;,", pos);
+            if(end == std::string::npos)
+                end = input.size();
+            std::string parameter_name = input.substr(pos, end - pos);
+            pos = end;
+
+            // 2.6. Consume any leading BWS.
+            skipOws(input, pos);
+
+            std::string parameter_value;
+
+            // 2.7. If the next character is "=":
+            if(pos < input.size() && input[pos] == '=') {
+                // 2.7.1. Discard the leading "=" character.
+                ++pos;
+
+                // 2.7.2. Consume any leading BWS.
+                skipOws(input, pos);
+
+                // 2.7.3. If the next character is DQUOTE, let parameter_value be
+                //        the result of Parsing a Quoted String.
+                if(pos < input.size() && input[pos] == '"')
+                    parameter_value = parseQuotedString(input, pos);
+
+                // 2.7.4. Else, consume the contents up to but not including the
+                //        first ";" or "," character, or up to the end of input.
+                else {
+                    end = input.find_first_of(";,", pos);
+                    if(end == std::string::npos)
+                        end = input.size();
+                    parameter_value = input.substr(pos, end - pos);
+                    pos = end;
+                }
+
+                // 2.7.5. RFC 8187 decoding is not done, as in http-link-header.h.
+            }
+
+            // 2.8. Else, parameter_value is the empty string.
+
+            // 2.9. Case-normalise parameter_name to lowercase.
+            // 2.10. Append (parameter_name, parameter_value) to parameters.
+            parameters.push_back(http_link_header::TargetAttribute(lowercase(parameter_name), parameter_value));
+
+            // 2.11. Consume any leading OWS.
+            skipOws(input, pos);
+
+            // 2.12. If the next character is "," or the end of input, stop
+            //       processing input and return parameters.
+            if(pos >= input.size())
+                return parameters;
+            if(input[pos] == ',') {
+                ++pos;
+                return parameters;
+            }
+        }
+
+        return parameters;
+    }
+
+    /**
+     * Appendix B.2.
+     *
+     * @param stop if not null, set to where parsing stopped: the end of
+     *        field_value, or the start of the link-value of step 2 or 5
+     */
+    inline std::vector<http_link_header::Link> parse(const std::string &field_value, const std::string &baseUri = "",
+                                                     std::size_t *stop = nullptr) {
+        using http_link_header::TargetAttribute;
+
+        std::vector<http_link_header::Link> links;
+        std::size_t pos = 0;
+        std::size_t ignored;
+        if(!stop)
+            stop = &ignored;
+        *stop = 0;
+
+        // While field_value has content:
+        while(pos < field_value.size()) {
+            // 1. Consume any leading OWS.
+            skipOws(field_value, pos);
+
+            // 2. If the first character is not "<", return links.
+            *stop = pos;
+            if(pos >= field_value.size() || field_value[pos] != '<')
+                return links;
+
+            // 3. Discard the first character ("<").
+            ++pos;
+
+            // 4. Consume up to but not including the first ">" character or
+            //    end of field_value and let the result be target_string.
+            std::size_t end = field_value.find('>', pos);
+
+            // 5. If the next character is not ">", return links.
+            if(end == std::string::npos)
+                return links;
+            std::string target_string = field_value.substr(pos, end - pos);
+
+            // 6. Discard the leading ">" character.
+            pos = end + 1;
+
+            // 7. Let link_parameters be the result of Parsing Parameters.
+            std::vector<TargetAttribute> link_parameters = parseParameters(field_value, pos);
+
+            // A link-value without parameters ends at a ",", which step 2.2
+            // of Parsing Parameters leaves unconsumed.
+            if(link_parameters.empty() && pos < field_value.size() && field_value[pos] == ',')
+                ++pos;
+
+            // 8. Let target_uri be the result of relatively resolving
+            //    target_string.
+            std::string target_uri;
+            if(!http_link_header::uri::resolve(&baseUri, &target_string, &target_uri))
+                target_uri = target_string;
+
+            // 9. Let relations_string be the second item of the first tuple
+            //    of link_parameters whose first item matches "rel", or the
+            //    empty string if it is not present.
+            std::string relations_string;
+            for(const auto &param : link_parameters) {
+                if(param.name == "rel") {
+                    relations_string = param.value;
+                    break;
+                }
+            }
+
+            // 10. Split relations_string on RWS into a list of relation_types.
+            //     A relations_string without any relation type gives a single
+            //     empty one.
+            std::vector<std::string> relation_types;
+            std::size_t start = 0;
+            while((start = relations_string.find_first_not_of(" \t", start)) != std::string::npos) {
+                std::size_t stop = relations_string.find_first_of(" \t", start);
+                if(stop == std::string::npos)
+                    stop = relations_string.size();
+                relation_types.push_back(relations_string.substr(start, stop - start));
+                start = stop;
+            }
+            if(relation_types.empty())
+                relation_types.push_back("");
+
+            // 11. Let context_string be the second item of the first tuple of
+            //     link_parameters whose first item matches "anchor".
+            std::string context_string;
+            for(const auto &param : link_parameters) {
+                if(param.name == "anchor") {
+                    context_string = param.value;
+                    break;
+                }
+            }
+
+            // 12. Let context_uri be the result of relatively resolving
+            //     context_string.
+            std::string context_uri;
+            if(!http_link_header::uri::resolve(&baseUri, &context_string, &context_uri))
+                context_uri = context_string;
+
+            // 13. Let target_attributes be an empty list.
+            std::vector<TargetAttribute> target_attributes;
+
+            // 14. For each tuple (param_name, param_value) of link_parameters:
+            for(const auto &param : link_parameters) {
+                // 14.1. If param_name matches "rel" or "anchor", skip this tuple.
+                if(param.name == "rel" || param.name == "anchor")
+                    continue;
+
+                // 14.2. If param_name matches "media", "title", "title*", or
+                //       "type" and target_attributes already contains a tuple
+                //       whose first element matches the value of param_name,
+                //       skip this tuple.
+                if(param.name == "media" || param.name == "title" || param.name == "title*" ||
+                   param.name == "type") {
+                    bool present = false;
+                    for(const auto &attribute : target_attributes)
+                        present = present || attribute.name == param.name;
+                    if(present)
+                        continue;
+                }
+
+                // 14.3. Append (param_name, param_value) to target_attributes.
+                target_attributes.push_back(param);
+            }
+
+            // 15. Let star_param_names be the set of param_names in
+            //     target_attributes whose last character is "*".
+            std::set<std::string> star_param_names;
+            for(const auto &attribute : target_attributes) {
+                if(!attribute.name.empty() && attribute.name.back() == '*')
+                    star_param_names.insert(attribute.name);
+            }
+
+            // 16. For each star_param_name in star_param_names:
+            for(const auto &star_param_name : star_param_names) {
+                // 16.1. Let base_param_name be star_param_name with the last
+                //       character removed.
+                std::string base_param_name = star_param_name.substr(0, star_param_name.size() - 1);
+
+                // 16.2. Every internationalised form is supported.
+
+                // 16.3. Remove all tuples from target_attributes whose first
+                //       member is base_param_name.
+                target_attributes.erase(
+                        std::remove_if(target_attributes.begin(), target_attributes.end(),
+                                       [&](const TargetAttribute &x) { return x.name == base_param_name; }),
+                        target_attributes.end());
+
+                // 16.4. Change the first member of all tuples in
+                //       target_attributes whose first member is
+                //       star_param_name to base_param_name.
+                for(auto &attribute : target_attributes) {
+                    if(attribute.name == star_param_name)
+                        attribute.name = base_param_name;
+                }
+            }
+
+            // 17. For each relation_type in relation_types:
+            for(const auto &relation_type : relation_types) {
+                // 17.1. Case-normalise relation_type to lowercase.
+                // 17.2. Append a link object to links.
+                links.push_back(http_link_header::Link(context_uri, lowercase(relation_type), target_uri,
+                                                       target_attributes));
+            }
+            *stop = pos;
+        }
+
+        return links;
+    }
+
+}
+
+#endif //HLH_TEST_REFERENCE_PARSER_H
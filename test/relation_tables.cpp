@@ -0,0 +1,118 @@
+// This file generates the perfect hash of the registered relation types in
+// http-link-header.h ("hash and displace", see detail::relationSlot()) from
+// detail::relationNames(): the tables of relationDisplacements() and
+// relationSlots(), and maxRelationNameSize.
+//
+// After adding or renaming a member of Relation and its name, run
+//
+//     ./test/relation_tables
+//
+// and paste what it prints into the header. With --check it prints nothing
+// and fails if the header does not have these tables, which ctest runs.
+
+#include "http-link-header.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+    namespace detail = http_link_header::detail;
+
+    class Tables {
+    public:
+        std::vector<std::uint16_t> displacements;
+        std::vector<std::uint8_t> slots;
+        std::size_t maxNameSize;
+    };
+
+    /**
+     * Places the buckets with the most relation types first, giving each
+     * the smallest displacement that puts all its relation types into free
+     * slots.
+     */
+    bool generate(Tables &tables) {
+        const std::uint32_t count = static_cast<std::uint32_t>(http_link_header::Relation::Extension);
+        const char *const *names = detail::relationNames();
+
+        std::vector<std::vector<std::uint32_t>> buckets(detail::relationBuckets);
+        tables.maxNameSize = 0;
+        for(std::uint32_t id = 1; id < count; ++id) {
+            std::size_t size = std::strlen(names[id]);
+            buckets[detail::relationHash(names[id], size) & (detail::relationBuckets - 1)].push_back(id);
+            tables.maxNameSize = std::max(tables.maxNameSize, size);
+        }
+
+        std::vector<std::uint32_t> order(detail::relationBuckets);
+        for(std::uint32_t b = 0; b < order.size(); ++b)
+            order[b] = b;
+        std::stable_sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+            return buckets[a].size() > buckets[b].size();
+        });
+
+        tables.displacements.assign(detail::relationBuckets, 0);
+        tables.slots.assign(detail::relationSlotCount, 0);
+        for(std::uint32_t b : order) {
+            std::vector<std::uint32_t> placed;
+            std::uint32_t d = 1;
+            for(; d <= 0xFFFF; ++d) {
+                placed.clear();
+                for(std::uint32_t id : buckets[b]) {
+                    std::uint32_t hash = detail::relationHash(names[id], std::strlen(names[id]));
+                    std::uint32_t slot = detail::relationSlot(hash, d);
+                    if(tables.slots[slot] != 0 || std::find(placed.begin(), placed.end(), slot) != placed.end())
+                        break;
+                    placed.push_back(slot);
+                }
+                if(placed.size() == buckets[b].size())
+                    break;
+            }
+            if(d > 0xFFFF)
+                return false;
+
+            tables.displacements[b] = static_cast<std::uint16_t>(d);
+            for(std::size_t i = 0; i < placed.size(); ++i)
+                tables.slots[placed[i]] = static_cast<std::uint8_t>(buckets[b][i]);
+        }
+        return true;
+    }
+
+    template<typename T>
+    void print(const char *function, const std::vector<T> &values) {
+        std::printf("%s\n", function);
+        for(std::size_t i = 0; i < values.size(); ++i)
+            std::printf("%s%3u%s", i % 16 == 0 ? "                " : " ", static_cast<unsigned>(values[i]),
+                        i + 1 == values.size() ? "\n" : i % 16 == 15 ? ",\n" : ",");
+    }
+
+}
+
+int main(int argc, char **argv) {
+    bool check = argc > 1 && std::string(argv[1]) == "--check";
+
+    Tables tables;
+    if(!generate(tables)) {
+        std::fprintf(stderr, "no displacement fits, make relationSlotCount larger\n");
+        return 1;
+    }
+
+    if(check) {
+        bool same = tables.maxNameSize == detail::maxRelationNameSize &&
+                    std::equal(tables.displacements.begin(), tables.displacements.end(),
+                               detail::relationDisplacements()) &&
+                    std::equal(tables.slots.begin(), tables.slots.end(), detail::relationSlots());
+        if(!same)
+            std::fprintf(stderr, "the relation tables in http-link-header.h are stale, run relation_tables\n");
+        return same ? 0 : 1;
+    }
+
+    std::printf("maxRelationNameSize = %u;\n\n", static_cast<unsigned>(tables.maxNameSize));
+    print("relationDisplacements():", tables.displacements);
+    std::printf("\n");
+    print("relationSlots():", tables.slots);
+    return 0;
+}
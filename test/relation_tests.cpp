@@ -0,0 +1,72 @@
+// This file contains tests for classifying and interning relation types
+
+#include "http-link-header.h"
+#include "doctest.h"
+
+#include <cctype>
+#include <string>
+
+using http_link_header::Relation;
+using http_link_header::RelationId;
+
+
+TEST_CASE("every registered relation type classifies as itself") {
+    // a stale perfect hash (see relation_tables.cpp) misclassifies some
+    for(RelationId id = 1; id < static_cast<RelationId>(Relation::Extension); ++id) {
+        auto name = http_link_header::relationName(id);
+        CHECK(!name.empty());
+        CHECK(name.size() <= http_link_header::detail::maxRelationNameSize);
+        CHECK(http_link_header::registeredRelation(name) == static_cast<Relation>(id));
+
+        std::string upper = name.str();
+        for(char &c : upper)
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        CHECK(http_link_header::registeredRelation(upper) == static_cast<Relation>(id));
+    }
+
+    // there is a name for each member of Relation and no more
+    CHECK(std::string(http_link_header::detail::relationNames()[static_cast<RelationId>(Relation::Extension)]).empty());
+}
+
+TEST_CASE("registered relation types are classified ignoring case") {
+    CHECK(http_link_header::registeredRelation("next") == Relation::Next);
+    CHECK(http_link_header::registeredRelation("NEXT") == Relation::Next);
+    CHECK(http_link_header::registeredRelation("Canonical") == Relation::Canonical);
+    CHECK(http_link_header::registeredRelation("apple-touch-startup-image") == Relation::AppleTouchStartupImage);
+    CHECK(http_link_header::registeredRelation("openid2.local_id") == Relation::Openid2LocalId);
+}
+
+TEST_CASE("unregistered relation types are extensions") {
+    CHECK(http_link_header::registeredRelation("") == Relation::None);
+    CHECK(http_link_header::registeredRelation("nex") == Relation::Extension);
+    CHECK(http_link_header::registeredRelation("nextt") == Relation::Extension);
+    CHECK(http_link_header::registeredRelation("http://example.net/foo") == Relation::Extension);
+    CHECK(http_link_header::registeredRelation(std::string(1000, 'a')) == Relation::Extension);
+}
+
+TEST_CASE("extension relation types are interned") {
+    RelationId a = http_link_header::relationId("http://example.net/relation-test");
+    RelationId b = http_link_header::relationId("HTTP://EXAMPLE.NET/relation-test");
+    RelationId c = http_link_header::relationId("http://example.net/relation-test-2");
+
+    CHECK(a > static_cast<RelationId>(Relation::Extension));
+    CHECK(a == b);
+    CHECK(a != c);
+    CHECK(http_link_header::relationName(a) == "http://example.net/relation-test");
+    CHECK(http_link_header::relationName(a + 1000000).empty());
+}
+
+TEST_CASE("parse sets relation identifiers") {
+    auto links = http_link_header::parse(R"(</a>; rel="Next http://example.net/foo", </b>)");
+
+    CHECK(links.size() == 3);
+    CHECK(links[0].hasRelation(Relation::Next));
+    CHECK(links[1].linkRelationId == http_link_header::relationId("http://example.net/foo"));
+    CHECK(links[2].hasRelation(Relation::None));
+}
+
+TEST_CASE("links built by hand have no relation identifier") {
+    http_link_header::Link link{"a", "next", "c", {}};
+
+    CHECK(link.hasRelation(Relation::None));
+}
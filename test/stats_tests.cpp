@@ -0,0 +1,87 @@
+// This file contains tests for the parse statistics. It is built into the
+// instrumented_tests executable with HLH_ENABLE_STATS defined, see
+// CMakeLists.txt.
+
+#include "http-link-header.h"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+
+#include <thread>
+
+namespace {
+
+    /**
+     * The difference between two snapshots of the statistics.
+     */
+    http_link_header::Stats since(const http_link_header::Stats &before) {
+        http_link_header::Stats now = http_link_header::stats();
+        return http_link_header::Stats{now.headers - before.headers,
+                                       now.bytes - before.bytes,
+                                       now.links - before.links,
+                                       now.parameters - before.parameters,
+                                       now.starParameters - before.starParameters,
+                                       now.resolutions - before.resolutions,
+                                       now.failedResolutions - before.failedResolutions,
+                                       now.earlyExits - before.earlyExits,
+                                       now.resolveNanoseconds - before.resolveNanoseconds,
+                                       now.tokenizeNanoseconds - before.tokenizeNanoseconds};
+    }
+
+}
+
+TEST_CASE("stats are compiled in") {
+    CHECK(http_link_header::Stats::enabled());
+}
+
+TEST_CASE("stats count headers, bytes, links and parameters") {
+    std::string header = R"(</a>; rel="next last"; title="t"; title*=UTF-8''t, </b>; rel=prev  )";
+    auto before = http_link_header::stats();
+    auto links = http_link_header::parse(header);
+    auto stats = since(before);
+
+    CHECK(links.size() == 3);
+    CHECK(stats.headers == 1);
+    CHECK(stats.bytes == header.size());
+    CHECK(stats.links == 3);
+    CHECK(stats.parameters == 4);
+    CHECK(stats.starParameters == 1);
+    CHECK(stats.earlyExits == 0);
+    CHECK(stats.tokenizeNanoseconds > 0);
+}
+
+TEST_CASE("stats count resolutions and the ones that failed") {
+    auto before = http_link_header::stats();
+    http_link_header::parseGroups("</a>; anchor=\"#x\", </b>", "https://example.com/");
+    http_link_header::parse("</a>");
+    auto stats = since(before);
+
+    CHECK(stats.headers == 2);
+    // target and context of each link-value
+    CHECK(stats.resolutions == 6);
+    // without a base URI there is nothing to resolve against
+    CHECK(stats.failedResolutions == 2);
+    CHECK(stats.resolveNanoseconds > 0);
+}
+
+TEST_CASE("stats count parsing that stopped at a malformed link-value") {
+    auto before = http_link_header::stats();
+    http_link_header::parse("</a>, b");
+    http_link_header::parse("</a>; rel=next, </b");
+    http_link_header::parse("</a>; rel=next,   ");
+    auto stats = since(before);
+
+    CHECK(stats.headers == 3);
+    CHECK(stats.links == 3);
+    CHECK(stats.earlyExits == 2);
+}
+
+TEST_CASE("stats include threads that have exited") {
+    auto before = http_link_header::stats();
+    std::thread thread([] { http_link_header::parse("</a>; rel=next"); });
+    thread.join();
+    auto stats = since(before);
+
+    CHECK(stats.headers == 1);
+    CHECK(stats.links == 1);
+}
@@ -0,0 +1,116 @@
+// This file contains tests that run the parser from several threads at once
+// and check that every thread gets the single-threaded results
+
+#include "http-link-header.h"
+#include "doctest.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    const unsigned threadCount = 8;
+    const int rounds = 200;
+
+    const char *const headers[] = {
+            R"(<https://example.com/TheBook/chapter2>; rel="previous"; title="previous chapter")",
+            R"(</a>; rel="next LAST http://example.net/shared-relation"; type=text/html, </b>; rel=first)",
+            R"(</terms>; rel="copyright"; anchor="#foo", <../styles/main.css>; rel=preload; as=style)",
+            R"(</x>; TITLE*=UTF-8'de'letztes%20Kapitel; title="a \"quoted\" title"; x*=1; x=2)",
+            R"(<https://api.github.com/repositories/1/issues?page=2>; rel="prev", )"
+            R"(<https://api.github.com/repositories/1/issues?page=4>; rel="next")"};
+
+    const std::string baseUri = "https://example.org/a/b";
+
+    /**
+     * Runs fn(thread) on threadCount threads that are released together.
+     */
+    template<typename Fn>
+    void runThreads(Fn fn) {
+        std::atomic<bool> go(false);
+        std::vector<std::thread> threads;
+        for(unsigned t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&go, &fn, t] {
+                while(!go.load())
+                    std::this_thread::yield();
+                fn(t);
+            });
+        }
+        go.store(true);
+        for(auto &thread : threads)
+            thread.join();
+    }
+
+}
+
+TEST_CASE("parse from several threads gives the single-threaded results") {
+    std::vector<std::vector<http_link_header::Link>> expected;
+    for(const char *header : headers)
+        expected.push_back(http_link_header::parse(header, baseUri));
+
+    std::atomic<int> mismatches(0);
+    runThreads([&](unsigned) {
+        for(int round = 0; round < rounds; ++round) {
+            for(std::size_t i = 0; i < expected.size(); ++i) {
+                auto links = http_link_header::parse(headers[i], baseUri);
+                bool same = links == expected[i];
+                for(std::size_t j = 0; same && j < links.size(); ++j)
+                    same = links[j].sameRelation(expected[i][j]);
+                if(!same)
+                    ++mismatches;
+            }
+        }
+    });
+
+    CHECK(mismatches.load() == 0);
+}
+
+TEST_CASE("parseGroups and extract_pagination from several threads give the single-threaded results") {
+    std::vector<std::vector<http_link_header::Link>> expected;
+    for(const char *header : headers)
+        expected.push_back(http_link_header::expand(http_link_header::parseGroups(header, baseUri)));
+    auto pagination = http_link_header::extract_pagination(headers[4]);
+
+    std::atomic<int> mismatches(0);
+    runThreads([&](unsigned) {
+        for(int round = 0; round < rounds; ++round) {
+            for(std::size_t i = 0; i < expected.size(); ++i) {
+                if(http_link_header::expand(http_link_header::parseGroups(headers[i], baseUri)) != expected[i])
+                    ++mismatches;
+            }
+            auto p = http_link_header::extract_pagination(headers[4]);
+            if(p.next.page != pagination.next.page || p.prev.target != pagination.prev.target)
+                ++mismatches;
+        }
+    });
+
+    CHECK(mismatches.load() == 0);
+}
+
+TEST_CASE("extension relation types interned from several threads get one identifier each") {
+    const int names = 64;
+
+    // threads of the same parity intern the same new names, each in a
+    // different order
+    std::vector<std::vector<http_link_header::RelationId>> ids(threadCount,
+                                                               std::vector<http_link_header::RelationId>(names));
+    runThreads([&](unsigned t) {
+        for(int round = 0; round < 4; ++round) {
+            for(int n = 0; n < names; ++n) {
+                int name = (n + static_cast<int>(t) * 7) % names;
+                ids[t][name] = http_link_header::relationId(
+                        "http://example.net/thread-test-" + std::to_string(name) + (t % 2 ? "" : "/"));
+            }
+        }
+    });
+
+    for(unsigned t = 2; t < threadCount; ++t)
+        CHECK(ids[t] == ids[t % 2]);
+    for(int n = 0; n < names; ++n) {
+        CHECK(ids[0][n] != ids[1][n]);
+        auto name = http_link_header::relationName(ids[1][n]).str();
+        CHECK(name == "http://example.net/thread-test-" + std::to_string(n));
+    }
+}
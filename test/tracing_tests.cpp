@@ -0,0 +1,81 @@
+// This file contains tests for the tracing hooks. It is built into the
+// instrumented_tests executable with HLH_ENABLE_TRACING defined, see
+// CMakeLists.txt.
+
+#include "http-link-header.h"
+#include "doctest.h"
+
+#include <string>
+#include <vector>
+
+using http_link_header::TracePhase;
+
+namespace {
+
+    class Event {
+    public:
+        TracePhase phase;
+        bool begin;
+
+        bool operator==(const Event &rhs) const {
+            return phase == rhs.phase && begin == rhs.begin;
+        }
+    };
+
+    void record(TracePhase phase, bool begin, void *context) {
+        static_cast<std::vector<Event>*>(context)->push_back(Event{phase, begin});
+    }
+
+    /**
+     * The begin and end events of the phases of one link-value.
+     */
+    std::vector<Event> linkValue(bool parse) {
+        std::vector<Event> events;
+        for(TracePhase phase : {TracePhase::TokenizeLinkValue, TracePhase::ResolveTarget,
+                                TracePhase::ProcessParameters, TracePhase::ResolveContext,
+                                TracePhase::ExpandRelations}) {
+            events.push_back(Event{phase, true});
+            events.push_back(Event{phase, false});
+        }
+        if(parse) {
+            events.push_back(Event{TracePhase::AppendLinks, true});
+            events.push_back(Event{TracePhase::AppendLinks, false});
+        }
+        return events;
+    }
+
+}
+
+TEST_CASE("tracing hook sees every phase of every link-value in order") {
+    std::vector<Event> events;
+    CHECK(http_link_header::setTraceHook(record, &events));
+    http_link_header::parse(R"(</a>; rel="next last"; title*=UTF-8''a, </b>)", "https://example.com/");
+    http_link_header::setTraceHook(nullptr);
+
+    std::vector<Event> expected = linkValue(true);
+    std::vector<Event> second = linkValue(true);
+    expected.insert(expected.end(), second.begin(), second.end());
+    CHECK(events == expected);
+}
+
+TEST_CASE("tracing hook sees the tokenizing of a malformed link-value") {
+    std::vector<Event> events;
+    http_link_header::setTraceHook(record, &events);
+    auto groups = http_link_header::parseGroups("</a>, b");
+    http_link_header::setTraceHook(nullptr);
+
+    std::vector<Event> expected = linkValue(false);
+    expected.push_back(Event{TracePhase::TokenizeLinkValue, true});
+    expected.push_back(Event{TracePhase::TokenizeLinkValue, false});
+    CHECK(groups.size() == 1);
+    CHECK(events == expected);
+}
+
+TEST_CASE("removed tracing hook is not called") {
+    std::vector<Event> events;
+    http_link_header::setTraceHook(record, &events);
+    http_link_header::setTraceHook(nullptr);
+    http_link_header::parse("</a>; rel=next");
+
+    CHECK(events.empty());
+}